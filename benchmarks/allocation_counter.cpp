@@ -0,0 +1,96 @@
+#include "allocation_counter.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#ifdef COUNT_ALLOCATIONS
+
+namespace {
+
+std::atomic<int64_t> allocations{0};
+std::atomic<int64_t> allocated_bytes{0};
+
+void Count(size_t size) {
+  allocations.fetch_add(1, std::memory_order_relaxed);
+  allocated_bytes.fetch_add(static_cast<int64_t>(size),
+                            std::memory_order_relaxed);
+}
+
+}  // namespace
+
+// The array and nothrow forms of new and delete call these in libstdc++ and
+// libc++, so replacing them catches every allocation. The sized deletes are
+// defined as well, since a replaced unsized delete without them trips
+// -Wsized-deallocation.
+void* operator new(size_t size) {
+  Count(size);
+  if (void* ptr = std::malloc(size == 0 ? 1 : size)) {
+    return ptr;
+  }
+  throw std::bad_alloc();
+}
+
+void* operator new(size_t size, std::align_val_t alignment) {
+  Count(size);
+  size_t align = static_cast<size_t>(alignment);
+  // aligned_alloc wants a size that is a multiple of the alignment.
+  size_t rounded = size == 0 ? align : (size + align - 1) / align * align;
+  if (void* ptr = std::aligned_alloc(align, rounded)) {
+    return ptr;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+
+void operator delete(void* ptr, std::align_val_t) noexcept { std::free(ptr); }
+
+void operator delete(void* ptr, size_t) noexcept { std::free(ptr); }
+
+void operator delete(void* ptr, size_t, std::align_val_t) noexcept {
+  std::free(ptr);
+}
+
+bool CountingAllocations() { return true; }
+
+AllocationCount CurrentAllocations() {
+  AllocationCount count;
+  count.allocations = allocations.load(std::memory_order_relaxed);
+  count.bytes = allocated_bytes.load(std::memory_order_relaxed);
+  return count;
+}
+
+#else
+
+bool CountingAllocations() { return false; }
+
+AllocationCount CurrentAllocations() { return AllocationCount(); }
+
+#endif
+
+AllocationReport::AllocationReport(benchmark::State& state)
+    : state_(state), start_(CurrentAllocations()) {}
+
+AllocationReport::~AllocationReport() {
+  if (!stopped_) {
+    Stop();
+  }
+}
+
+void AllocationReport::Stop() {
+  // Read the count before touching state_.counters, whose map nodes are
+  // allocated too.
+  AllocationCount end = CurrentAllocations();
+  stopped_ = true;
+  if (!CountingAllocations()) {
+    return;
+  }
+  state_.counters["allocs"] =
+      benchmark::Counter(static_cast<double>(end.allocations -
+                                             start_.allocations),
+                         benchmark::Counter::kAvgIterations);
+  state_.counters["bytes"] = benchmark::Counter(
+      static_cast<double>(end.bytes - start_.bytes),
+      benchmark::Counter::kAvgIterations, benchmark::Counter::kIs1024);
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+
+#include <benchmark/benchmark.h>
+
+// Opt-in heap instrumentation for the benchmarks. Configured with
+// -DCOUNT_ALLOCATIONS=ON, allocation_counter.cpp replaces the global
+// operator new and counts every call and every requested byte; otherwise
+// nothing is replaced and the counts stay 0, so timings are not affected.
+struct AllocationCount {
+  int64_t allocations = 0;
+  int64_t bytes = 0;
+};
+
+// Whether this build counts allocations.
+bool CountingAllocations();
+
+// Allocations made by the whole process so far.
+AllocationCount CurrentAllocations();
+
+// Reports the allocations made between its construction and Stop() as the
+// per-iteration counters "allocs" and "bytes". Construct it right before the
+// benchmark loop and stop it right after, before anything else allocates
+// (setting counters or SetBytesProcessed does):
+//
+//   AllocationReport report(state);
+//   for (auto _ : state) { ... }
+//   report.Stop();
+//
+// The destructor stops a report that was not stopped. Does nothing unless
+// CountingAllocations().
+class AllocationReport {
+public:
+  explicit AllocationReport(benchmark::State& state);
+
+  AllocationReport(const AllocationReport&) = delete;
+  AllocationReport& operator=(const AllocationReport&) = delete;
+
+  ~AllocationReport();
+
+  void Stop();
+
+private:
+  benchmark::State& state_;
+  AllocationCount start_;
+  bool stopped_ = false;
+};
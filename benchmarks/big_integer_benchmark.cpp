@@ -0,0 +1,129 @@
+// BigInt benchmarks. The argument is the number of decimal digits of the
+// operands; division and remainder divide a 2n-digit number by an n-digit
+// one.
+//
+// Parsing, printing, + and - are linear and run up to 10^6 digits. * and
+// the long division behind / and % are quadratic, and division does ten
+// BigInt multiplications per digit, so they stop at kMultiplyMaxDigits and
+// kDivideMaxDigits: one step further a single operation takes seconds.
+
+#include <random>
+#include <sstream>
+#include <string>
+
+#include <benchmark/benchmark.h>
+
+#include "../big_integer/big_integer.hpp"
+#include "allocation_counter.hpp"
+
+namespace {
+
+const int64_t kMaxDigits = 1000000;
+const int64_t kMultiplyMaxDigits = 100000;
+const int64_t kDivideMaxDigits = 1000;
+
+std::string RandomDigits(size_t digits, unsigned seed) {
+  std::mt19937 rng(seed);
+  std::string str(digits, '0');
+  for (char& digit : str) {
+    digit = static_cast<char>('0' + rng() % 10);
+  }
+  str[0] = static_cast<char>('1' + rng() % 9);
+  return str;
+}
+
+void BM_Parse(benchmark::State& state) {
+  std::string str = RandomDigits(state.range(0), 1);
+  AllocationReport report(state);
+  for (auto _ : state) {
+    BigInt number(str);
+    benchmark::DoNotOptimize(number);
+  }
+  report.Stop();
+  state.SetBytesProcessed(state.iterations() * str.size());
+}
+BENCHMARK(BM_Parse)->RangeMultiplier(10)->Range(10, kMaxDigits);
+
+void BM_Print(benchmark::State& state) {
+  BigInt number(RandomDigits(state.range(0), 1));
+  AllocationReport report(state);
+  for (auto _ : state) {
+    std::ostringstream out;
+    out << number;
+    benchmark::DoNotOptimize(out);
+  }
+  report.Stop();
+  state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_Print)->RangeMultiplier(10)->Range(10, kMaxDigits);
+
+void BM_Add(benchmark::State& state) {
+  BigInt left(RandomDigits(state.range(0), 1));
+  BigInt right(RandomDigits(state.range(0), 2));
+  AllocationReport report(state);
+  for (auto _ : state) {
+    BigInt sum = left + right;
+    benchmark::DoNotOptimize(sum);
+  }
+  report.Stop();
+}
+BENCHMARK(BM_Add)->RangeMultiplier(10)->Range(10, kMaxDigits);
+
+void BM_Subtract(benchmark::State& state) {
+  BigInt left(RandomDigits(state.range(0), 1));
+  BigInt right(RandomDigits(state.range(0), 2));
+  AllocationReport report(state);
+  for (auto _ : state) {
+    BigInt diff = left - right;
+    benchmark::DoNotOptimize(diff);
+  }
+  report.Stop();
+}
+BENCHMARK(BM_Subtract)->RangeMultiplier(10)->Range(10, kMaxDigits);
+
+void BM_Multiply(benchmark::State& state) {
+  BigInt left(RandomDigits(state.range(0), 1));
+  BigInt right(RandomDigits(state.range(0), 2));
+  AllocationReport report(state);
+  for (auto _ : state) {
+    BigInt mul = left * right;
+    benchmark::DoNotOptimize(mul);
+  }
+  report.Stop();
+}
+BENCHMARK(BM_Multiply)
+    ->RangeMultiplier(10)
+    ->Range(10, kMultiplyMaxDigits)
+    ->Unit(benchmark::kMicrosecond);
+
+void BM_Divide(benchmark::State& state) {
+  BigInt dividend(RandomDigits(2 * state.range(0), 1));
+  BigInt divisor(RandomDigits(state.range(0), 2));
+  AllocationReport report(state);
+  for (auto _ : state) {
+    BigInt quotient = dividend / divisor;
+    benchmark::DoNotOptimize(quotient);
+  }
+  report.Stop();
+}
+BENCHMARK(BM_Divide)
+    ->RangeMultiplier(10)
+    ->Range(10, kDivideMaxDigits)
+    ->Unit(benchmark::kMicrosecond);
+
+void BM_Modulo(benchmark::State& state) {
+  BigInt dividend(RandomDigits(2 * state.range(0), 1));
+  BigInt divisor(RandomDigits(state.range(0), 2));
+  AllocationReport report(state);
+  for (auto _ : state) {
+    BigInt remainder = dividend % divisor;
+    benchmark::DoNotOptimize(remainder);
+  }
+  report.Stop();
+}
+BENCHMARK(BM_Modulo)
+    ->RangeMultiplier(10)
+    ->Range(10, kDivideMaxDigits)
+    ->Unit(benchmark::kMicrosecond);
+
+}  // namespace
@@ -0,0 +1,110 @@
+// Compares the blocked Matrix operator* against the former naive i-j-k loop
+// and reports GFLOP/s (2 * N^3 / time) for square matrices.
+//
+//   gemm_benchmark [max_size] [naive_max_size] [threads]
+//
+// Sizes run from 64 to max_size (default 2048), doubling. The naive loop is
+// only timed up to naive_max_size (default 1024) since it takes minutes
+// beyond that. threads sets the ThreadPool size (default 1, 0 = all cores).
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+#include "../matrix/matrix.hpp"
+
+namespace {
+
+template <size_t N, size_t M, size_t K, typename T>
+void NaiveMultiply(const Matrix<N, K, T>& left, const Matrix<K, M, T>& right,
+                   Matrix<N, M, T>& res) {
+  for (size_t index_x = 0; index_x < N; ++index_x) {
+    for (size_t index_y = 0; index_y < M; ++index_y) {
+      for (size_t index_z = 0; index_z < K; ++index_z) {
+        res(index_x, index_y) +=
+            left(index_x, index_z) * right(index_z, index_y);
+      }
+    }
+  }
+}
+
+template <size_t N, typename T>
+void Fill(Matrix<N, N, T>& matrix, std::mt19937& rng) {
+  for (size_t i = 0; i < N * N; ++i) {
+    matrix.Data()[i] = static_cast<T>(rng() % 16);
+  }
+}
+
+template <typename Function>
+double BestSeconds(int repeats, Function function) {
+  double best = 1e100;
+  for (int i = 0; i < repeats; ++i) {
+    auto start = std::chrono::steady_clock::now();
+    function();
+    std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+    best = std::min(best, elapsed.count());
+  }
+  return best;
+}
+
+template <size_t N, typename T>
+void Run(const char* type_name, size_t max_size, size_t naive_max_size) {
+  if (N > max_size) {
+    return;
+  }
+  std::mt19937 rng(N);
+  Matrix<N, N, T> left;
+  Matrix<N, N, T> right;
+  Fill(left, rng);
+  Fill(right, rng);
+
+  double flops = 2.0 * N * N * N;
+  int repeats = N <= 256 ? 10 : 3;
+  double blocked = BestSeconds(repeats, [&] {
+    Matrix<N, N, T> res = left * right;
+    if (res(0, 0) == T(-1)) {
+      std::abort();
+    }
+  });
+  std::printf("%-8s %5zu  blocked %8.2f GFLOP/s", type_name, N,
+              flops / blocked * 1e-9);
+  if (N <= naive_max_size) {
+    double naive = BestSeconds(N <= 256 ? 3 : 1, [&] {
+      Matrix<N, N, T> res;
+      NaiveMultiply(left, right, res);
+      if (res(0, 0) == T(-1)) {
+        std::abort();
+      }
+    });
+    std::printf("  naive %8.2f GFLOP/s  speedup %6.1fx",
+                flops / naive * 1e-9, naive / blocked);
+  }
+  std::printf("\n");
+}
+
+template <typename T>
+void RunAll(const char* type_name, size_t max_size, size_t naive_max_size) {
+  Run<64, T>(type_name, max_size, naive_max_size);
+  Run<128, T>(type_name, max_size, naive_max_size);
+  Run<256, T>(type_name, max_size, naive_max_size);
+  Run<512, T>(type_name, max_size, naive_max_size);
+  Run<1024, T>(type_name, max_size, naive_max_size);
+  Run<2048, T>(type_name, max_size, naive_max_size);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  size_t max_size = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 2048;
+  size_t naive_max_size =
+      argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 1024;
+  ThreadPool::Instance().SetThreadCount(
+      argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 1);
+  RunAll<float>("float", max_size, naive_max_size);
+  RunAll<double>("double", max_size, naive_max_size);
+  RunAll<int32_t>("int32_t", max_size, naive_max_size);
+  RunAll<int64_t>("int64_t", max_size, naive_max_size);
+  return 0;
+}
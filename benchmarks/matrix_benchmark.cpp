@@ -0,0 +1,116 @@
+// Matrix benchmarks on square N x N matrices of double, N from 4 to 1024.
+// Matrix sizes are template arguments, so every size is its own
+// instantiation; DynamicMatrix covers the same range with runtime sizes.
+// ThreadPool keeps its default single thread, so results do not depend on
+// the machine's core count.
+
+#include <random>
+
+#include <benchmark/benchmark.h>
+
+#include "../matrix/dynamic_matrix.hpp"
+#include "../matrix/matrix.hpp"
+#include "allocation_counter.hpp"
+
+namespace {
+
+template <typename Container>
+void Fill(Container& matrix, size_t size, unsigned seed) {
+  std::mt19937 rng(seed);
+  std::uniform_real_distribution<double> distribution(-1.0, 1.0);
+  for (size_t i = 0; i < size; ++i) {
+    matrix.Data()[i] = distribution(rng);
+  }
+}
+
+template <size_t N>
+void BM_Multiply(benchmark::State& state) {
+  Matrix<N, N, double> left;
+  Matrix<N, N, double> right;
+  Fill(left, N * N, 1);
+  Fill(right, N * N, 2);
+  AllocationReport report(state);
+  for (auto _ : state) {
+    Matrix<N, N, double> res = left * right;
+    benchmark::DoNotOptimize(res.Data());
+  }
+  report.Stop();
+  state.counters["FLOPS"] = benchmark::Counter(
+      2.0 * N * N * N, benchmark::Counter::kIsIterationInvariantRate);
+}
+
+template <size_t N>
+void BM_Transpose(benchmark::State& state) {
+  Matrix<N, N, double> matrix;
+  Fill(matrix, N * N, 1);
+  AllocationReport report(state);
+  for (auto _ : state) {
+    Matrix<N, N, double> transposed = matrix.Transposed();
+    benchmark::DoNotOptimize(transposed.Data());
+  }
+  report.Stop();
+  state.SetBytesProcessed(state.iterations() * 2 * N * N * sizeof(double));
+}
+
+template <size_t N>
+void BM_Add(benchmark::State& state) {
+  Matrix<N, N, double> left;
+  Matrix<N, N, double> right;
+  Fill(left, N * N, 1);
+  Fill(right, N * N, 2);
+  AllocationReport report(state);
+  for (auto _ : state) {
+    Matrix<N, N, double> sum = left + right;
+    benchmark::DoNotOptimize(sum.Data());
+  }
+  report.Stop();
+  state.SetBytesProcessed(state.iterations() * 3 * N * N * sizeof(double));
+}
+
+// In place, so no result matrix is allocated.
+template <size_t N>
+void BM_AddAssign(benchmark::State& state) {
+  Matrix<N, N, double> left;
+  Matrix<N, N, double> right;
+  Fill(left, N * N, 1);
+  Fill(right, N * N, 2);
+  AllocationReport report(state);
+  for (auto _ : state) {
+    left += right;
+    benchmark::DoNotOptimize(left.Data());
+  }
+  report.Stop();
+  state.SetBytesProcessed(state.iterations() * 3 * N * N * sizeof(double));
+}
+
+void BM_DynamicMultiply(benchmark::State& state) {
+  size_t size = state.range(0);
+  DynamicMatrix<double> left(size, size);
+  DynamicMatrix<double> right(size, size);
+  Fill(left, size * size, 1);
+  Fill(right, size * size, 2);
+  AllocationReport report(state);
+  for (auto _ : state) {
+    DynamicMatrix<double> res = left * right;
+    benchmark::DoNotOptimize(res.Data());
+  }
+  report.Stop();
+  state.counters["FLOPS"] =
+      benchmark::Counter(2.0 * size * size * size,
+                         benchmark::Counter::kIsIterationInvariantRate);
+}
+BENCHMARK(BM_DynamicMultiply)->RangeMultiplier(4)->Range(4, 1024);
+
+#define MATRIX_BENCHMARK(name)   \
+  BENCHMARK_TEMPLATE(name, 4);   \
+  BENCHMARK_TEMPLATE(name, 16);  \
+  BENCHMARK_TEMPLATE(name, 64);  \
+  BENCHMARK_TEMPLATE(name, 256); \
+  BENCHMARK_TEMPLATE(name, 1024)
+
+MATRIX_BENCHMARK(BM_Multiply);
+MATRIX_BENCHMARK(BM_Transpose);
+MATRIX_BENCHMARK(BM_Add);
+MATRIX_BENCHMARK(BM_AddAssign);
+
+}  // namespace
@@ -0,0 +1,161 @@
+// String benchmarks. The argument is the length of the text in bytes; Split
+// and Join work on words of kWordLength letters separated by spaces. The
+// UTF-8 benchmarks take a second argument: 0 for ASCII text with one
+// two-byte character in kAsciiRun, 1 for text made only of two-, three- and
+// four-byte characters.
+//
+//   string_benchmark [--benchmark_filter=<regex>]
+//                    [--benchmark_out=<file> --benchmark_out_format=json]
+
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "../string/string.hpp"
+#include "../string/utf8.hpp"
+#include "allocation_counter.hpp"
+
+namespace {
+
+const size_t kWordLength = 7;
+const size_t kAsciiRun = 64;
+
+String Words(size_t size) {
+  String text(size, 'a');
+  for (size_t i = kWordLength; i < size; i += kWordLength + 1) {
+    text[i] = ' ';
+  }
+  return text;
+}
+
+// Valid UTF-8 of exactly size bytes.
+std::string Utf8Text(size_t size, bool multibyte) {
+  const char* const kMultibyte[] = {"\xC3\xA9", "\xD0\xB6", "\xE2\x82\xAC",
+                                    "\xF0\x9F\x98\x80"};
+  std::string text;
+  text.reserve(size);
+  for (size_t i = 0; text.size() < size; ++i) {
+    std::string next = multibyte ? kMultibyte[i % 4]
+                       : i % kAsciiRun == 0 ? kMultibyte[0]
+                                            : "a";
+    if (text.size() + next.size() > size) {
+      next = "a";
+    }
+    text += next;
+  }
+  return text;
+}
+
+void BM_PushBack(benchmark::State& state) {
+  size_t size = state.range(0);
+  AllocationReport report(state);
+  for (auto _ : state) {
+    String str;
+    for (size_t i = 0; i < size; ++i) {
+      str.PushBack('a');
+    }
+    benchmark::DoNotOptimize(str.Data());
+  }
+  report.Stop();
+  state.SetBytesProcessed(state.iterations() * size);
+}
+BENCHMARK(BM_PushBack)->RangeMultiplier(8)->Range(8, 1 << 20);
+
+void BM_Split(benchmark::State& state) {
+  String text = Words(state.range(0));
+  AllocationReport report(state);
+  for (auto _ : state) {
+    std::vector<String> words = text.Split(" ");
+    benchmark::DoNotOptimize(words.data());
+  }
+  report.Stop();
+  state.SetBytesProcessed(state.iterations() * text.Size());
+}
+BENCHMARK(BM_Split)->RangeMultiplier(8)->Range(64, 1 << 20);
+
+// The same split without copying the pieces.
+void BM_SplitView(benchmark::State& state) {
+  String text = Words(state.range(0));
+  StringView view(text);
+  AllocationReport report(state);
+  for (auto _ : state) {
+    std::vector<StringView> words = view.Split(" ");
+    benchmark::DoNotOptimize(words.data());
+  }
+  report.Stop();
+  state.SetBytesProcessed(state.iterations() * text.Size());
+}
+BENCHMARK(BM_SplitView)->RangeMultiplier(8)->Range(64, 1 << 20);
+
+void BM_Join(benchmark::State& state) {
+  std::vector<String> words = Words(state.range(0)).Split(" ");
+  String delim(" ");
+  AllocationReport report(state);
+  for (auto _ : state) {
+    String text = delim.Join(words);
+    benchmark::DoNotOptimize(text.Data());
+  }
+  report.Stop();
+  state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_Join)->RangeMultiplier(8)->Range(64, 1 << 20);
+
+void BM_Concat(benchmark::State& state) {
+  String left(state.range(0) / 2, 'a');
+  String right(state.range(0) - left.Size(), 'b');
+  AllocationReport report(state);
+  for (auto _ : state) {
+    String sum = left + right;
+    benchmark::DoNotOptimize(sum.Data());
+  }
+  report.Stop();
+  state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_Concat)->RangeMultiplier(8)->Range(8, 1 << 20);
+
+// Strings that only differ in the last character, so the whole length is
+// compared.
+void BM_Compare(benchmark::State& state) {
+  String left(state.range(0), 'a');
+  String right(left);
+  right.Back() = 'b';
+  AllocationReport report(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(left < right);
+    benchmark::DoNotOptimize(left == right);
+  }
+  report.Stop();
+  state.SetBytesProcessed(state.iterations() * 2 * state.range(0));
+}
+BENCHMARK(BM_Compare)->RangeMultiplier(8)->Range(8, 1 << 20);
+
+void BM_Utf8Validate(benchmark::State& state) {
+  std::string text = Utf8Text(state.range(0), state.range(1) != 0);
+  StringView view(text.data(), text.size());
+  AllocationReport report(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(Utf8Validate(view));
+  }
+  report.Stop();
+  state.SetBytesProcessed(state.iterations() * text.size());
+}
+BENCHMARK(BM_Utf8Validate)
+    ->ArgNames({"bytes", "multibyte"})
+    ->ArgsProduct({{64, 4096, 1 << 20}, {0, 1}});
+
+void BM_Utf8Length(benchmark::State& state) {
+  std::string text = Utf8Text(state.range(0), state.range(1) != 0);
+  StringView view(text.data(), text.size());
+  AllocationReport report(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(Utf8Length(view));
+  }
+  report.Stop();
+  state.SetBytesProcessed(state.iterations() * text.size());
+}
+BENCHMARK(BM_Utf8Length)
+    ->ArgNames({"bytes", "multibyte"})
+    ->ArgsProduct({{64, 4096, 1 << 20}, {0, 1}});
+
+}  // namespace
@@ -0,0 +1,182 @@
+#pragma once
+
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+#include "matrix.hpp"
+#include "matrix_view.hpp"
+
+// Matrix whose size is only known at run time, with the operator set of
+// Matrix. Every DynamicMatrix<T> shares one instantiation whatever its size.
+// Shapes that would not compile for Matrix throw std::invalid_argument here.
+// Unlike Matrix, the arithmetic operators are evaluated eagerly.
+template <typename T = int64_t>
+class DynamicMatrix {
+public:
+  DynamicMatrix() = default;
+
+  DynamicMatrix(size_t rows, size_t cols, const T& elem = T())
+      : rows_(rows), cols_(cols), elements_(rows * cols, elem) {}
+
+  DynamicMatrix(const std::vector<std::vector<T>>& vectors)
+      : rows_(vectors.size()),
+        cols_(vectors.empty() ? 0 : vectors[0].size()) {
+    elements_.reserve(rows_ * cols_);
+    for (const auto& row : vectors) {
+      if (row.size() != cols_) {
+        throw std::invalid_argument("DynamicMatrix: ragged rows");
+      }
+      elements_.insert(elements_.end(), row.begin(), row.end());
+    }
+  }
+
+  // From a Matrix or a fixed-size expression over Matrix.
+  template <typename Expr, size_t N, size_t M>
+  explicit DynamicMatrix(const MatrixExpression<Expr, N, M, T>& expr)
+      : rows_(N), cols_(M) {
+    const Matrix<N, M, T>& matrix = Evaluate(expr);
+    elements_.assign(matrix.Data(), matrix.Data() + N * M);
+  }
+
+  // Copies the viewed elements.
+  explicit DynamicMatrix(const MatrixView<const T>& view)
+      : rows_(view.Rows()), cols_(view.Cols()) {
+    elements_.reserve(rows_ * cols_);
+    for (size_t i = 0; i < rows_; ++i) {
+      for (size_t j = 0; j < cols_; ++j) {
+        elements_.push_back(view(i, j));
+      }
+    }
+  }
+
+  template <size_t N, size_t M>
+  Matrix<N, M, T> ToMatrix() const {
+    if (rows_ != N || cols_ != M) {
+      throw std::invalid_argument("DynamicMatrix::ToMatrix: size mismatch");
+    }
+    Matrix<N, M, T> matrix;
+    std::copy(elements_.begin(), elements_.end(), matrix.Data());
+    return matrix;
+  }
+
+  size_t Rows() const { return rows_; }
+  size_t Cols() const { return cols_; }
+
+  friend DynamicMatrix operator+(const DynamicMatrix& left,
+                                 const DynamicMatrix& right) {
+    DynamicMatrix sum(left);
+    sum += right;
+    return sum;
+  }
+  friend DynamicMatrix operator-(const DynamicMatrix& left,
+                                 const DynamicMatrix& right) {
+    DynamicMatrix diff(left);
+    diff -= right;
+    return diff;
+  }
+
+  DynamicMatrix& operator+=(const DynamicMatrix& other) {
+    CheckSameShape(other);
+    T* elements = Data();
+    const T* other_elements = other.Data();
+    ForEachRowBlock(rows_, cols_, [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i) {
+        elements[i] += other_elements[i];
+      }
+    });
+    return *this;
+  }
+
+  DynamicMatrix& operator-=(const DynamicMatrix& other) {
+    CheckSameShape(other);
+    T* elements = Data();
+    const T* other_elements = other.Data();
+    ForEachRowBlock(rows_, cols_, [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i) {
+        elements[i] -= other_elements[i];
+      }
+    });
+    return *this;
+  }
+
+  friend DynamicMatrix operator*(const DynamicMatrix& matrix,
+                                 const T& number) {
+    DynamicMatrix mul(matrix);
+    T* elements = mul.Data();
+    ForEachRowBlock(mul.rows_, mul.cols_, [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i) {
+        elements[i] *= number;
+      }
+    });
+    return mul;
+  }
+  friend DynamicMatrix operator*(const T& number,
+                                 const DynamicMatrix& matrix) {
+    return matrix * number;
+  }
+
+  friend DynamicMatrix operator*(const DynamicMatrix& left,
+                                 const DynamicMatrix& right) {
+    if (left.cols_ != right.rows_) {
+      throw std::invalid_argument("DynamicMatrix: cannot multiply");
+    }
+    DynamicMatrix res(left.rows_, right.cols_);
+    Gemm(left.rows_, right.cols_, left.cols_, left.Data(), left.cols_,
+         right.Data(), right.cols_, res.Data(), res.cols_);
+    return res;
+  }
+
+  DynamicMatrix Transposed() const {
+    return DynamicMatrix(View().Transposed());
+  }
+
+  T Trace() const {
+    if (rows_ != cols_) {
+      throw std::invalid_argument("DynamicMatrix::Trace: not square");
+    }
+    T trace = 0;
+    for (size_t i = 0; i < rows_; ++i) {
+      trace += (*this)(i, i);
+    }
+    return trace;
+  }
+
+  T& operator()(size_t index_i, size_t index_j) {
+    return elements_[index_i * cols_ + index_j];
+  }
+  const T& operator()(size_t index_i, size_t index_j) const {
+    return elements_[index_i * cols_ + index_j];
+  }
+
+  bool operator==(const DynamicMatrix& other) const {
+    return rows_ == other.rows_ && cols_ == other.cols_ &&
+           elements_ == other.elements_;
+  }
+
+  MatrixView<T> View() { return MatrixView<T>(Data(), rows_, cols_, cols_); }
+  MatrixView<const T> View() const {
+    return MatrixView<const T>(Data(), rows_, cols_, cols_);
+  }
+
+  // Row-major elements: (i, j) is Data()[i * Cols() + j].
+  T* Data() { return elements_.data(); }
+  const T* Data() const { return elements_.data(); }
+
+  void Swap(DynamicMatrix& other) {
+    std::swap(rows_, other.rows_);
+    std::swap(cols_, other.cols_);
+    elements_.swap(other.elements_);
+  }
+
+private:
+  size_t rows_ = 0;
+  size_t cols_ = 0;
+  std::vector<T> elements_;
+
+  void CheckSameShape(const DynamicMatrix& other) const {
+    if (rows_ != other.rows_ || cols_ != other.cols_) {
+      throw std::invalid_argument("DynamicMatrix: shapes differ");
+    }
+  }
+};
@@ -0,0 +1,308 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#include "../thread_pool/thread_pool.hpp"
+
+// General matrix multiply on row-major blocks with leading dimensions:
+//   C (n x m, row stride ldc) += A (n x k, lda) * B (k x m, ldb).
+//
+// Arithmetic types go through a packed, cache-blocked loop nest (Goto/BLIS
+// style): a KC x NC panel of B and an MC x KC block of A are copied into
+// contiguous tiles, and a register-tiled microkernel computes kRows x kCols
+// pieces of C. With AVX2 (and FMA for floating point) float, double and
+// int32_t get hand-written microkernels; everything else uses a portable
+// kernel the compiler can vectorize. Small products and non-arithmetic T
+// (e.g. BigInt) use a plain i-k-j loop that allocates nothing.
+//
+// For every packed panel of B, the MC x kGemmTaskCols tiles of C are
+// independent tasks on ThreadPool; each task packs its own block of A.
+
+const size_t kGemmBlockK = 256;
+const size_t kGemmBlockM = 96;
+const size_t kGemmBlockN = 2048;
+const size_t kGemmTaskCols = 512;
+// n * m * k below this skips packing.
+const size_t kGemmSmallVolume = 32 * 32 * 32;
+
+template <typename T, typename Enable = void>
+struct GemmKernel {
+  static const size_t kRows = 4;
+  static const size_t kCols = 8;
+
+  // C[0, rows) x [0, cols) += A_panel * B_panel over kc steps.
+  static void Run(size_t kc, const T* a_panel, const T* b_panel, T* c,
+                  size_t ldc, size_t rows, size_t cols) {
+    T acc[kRows][kCols] = {};
+    for (size_t p = 0; p < kc; ++p) {
+      const T* a_col = a_panel + p * kRows;
+      const T* b_row = b_panel + p * kCols;
+      for (size_t r = 0; r < kRows; ++r) {
+        for (size_t col = 0; col < kCols; ++col) {
+          acc[r][col] += a_col[r] * b_row[col];
+        }
+      }
+    }
+    for (size_t r = 0; r < rows; ++r) {
+      for (size_t col = 0; col < cols; ++col) {
+        c[r * ldc + col] += acc[r][col];
+      }
+    }
+  }
+};
+
+#if defined(__AVX2__) && defined(__FMA__)
+
+template <>
+struct GemmKernel<float> {
+  static const size_t kRows = 6;
+  static const size_t kCols = 16;
+
+  static void Run(size_t kc, const float* a_panel, const float* b_panel,
+                  float* c, size_t ldc, size_t rows, size_t cols) {
+    __m256 acc[kRows][2];
+    for (size_t r = 0; r < kRows; ++r) {
+      acc[r][0] = _mm256_setzero_ps();
+      acc[r][1] = _mm256_setzero_ps();
+    }
+    for (size_t p = 0; p < kc; ++p) {
+      __m256 b0 = _mm256_loadu_ps(b_panel + p * kCols);
+      __m256 b1 = _mm256_loadu_ps(b_panel + p * kCols + 8);
+#pragma GCC unroll 8
+      for (size_t r = 0; r < kRows; ++r) {
+        __m256 a = _mm256_broadcast_ss(a_panel + p * kRows + r);
+        acc[r][0] = _mm256_fmadd_ps(a, b0, acc[r][0]);
+        acc[r][1] = _mm256_fmadd_ps(a, b1, acc[r][1]);
+      }
+    }
+    if (cols == kCols) {
+      for (size_t r = 0; r < rows; ++r) {
+        float* c_row = c + r * ldc;
+        _mm256_storeu_ps(c_row, _mm256_add_ps(_mm256_loadu_ps(c_row),
+                                              acc[r][0]));
+        _mm256_storeu_ps(c_row + 8, _mm256_add_ps(_mm256_loadu_ps(c_row + 8),
+                                                  acc[r][1]));
+      }
+      return;
+    }
+    alignas(32) float spill[kCols];
+    for (size_t r = 0; r < rows; ++r) {
+      _mm256_store_ps(spill, acc[r][0]);
+      _mm256_store_ps(spill + 8, acc[r][1]);
+      for (size_t col = 0; col < cols; ++col) {
+        c[r * ldc + col] += spill[col];
+      }
+    }
+  }
+};
+
+template <>
+struct GemmKernel<double> {
+  static const size_t kRows = 6;
+  static const size_t kCols = 8;
+
+  static void Run(size_t kc, const double* a_panel, const double* b_panel,
+                  double* c, size_t ldc, size_t rows, size_t cols) {
+    __m256d acc[kRows][2];
+    for (size_t r = 0; r < kRows; ++r) {
+      acc[r][0] = _mm256_setzero_pd();
+      acc[r][1] = _mm256_setzero_pd();
+    }
+    for (size_t p = 0; p < kc; ++p) {
+      __m256d b0 = _mm256_loadu_pd(b_panel + p * kCols);
+      __m256d b1 = _mm256_loadu_pd(b_panel + p * kCols + 4);
+#pragma GCC unroll 8
+      for (size_t r = 0; r < kRows; ++r) {
+        __m256d a = _mm256_broadcast_sd(a_panel + p * kRows + r);
+        acc[r][0] = _mm256_fmadd_pd(a, b0, acc[r][0]);
+        acc[r][1] = _mm256_fmadd_pd(a, b1, acc[r][1]);
+      }
+    }
+    if (cols == kCols) {
+      for (size_t r = 0; r < rows; ++r) {
+        double* c_row = c + r * ldc;
+        _mm256_storeu_pd(c_row, _mm256_add_pd(_mm256_loadu_pd(c_row),
+                                              acc[r][0]));
+        _mm256_storeu_pd(c_row + 4, _mm256_add_pd(_mm256_loadu_pd(c_row + 4),
+                                                  acc[r][1]));
+      }
+      return;
+    }
+    alignas(32) double spill[kCols];
+    for (size_t r = 0; r < rows; ++r) {
+      _mm256_store_pd(spill, acc[r][0]);
+      _mm256_store_pd(spill + 4, acc[r][1]);
+      for (size_t col = 0; col < cols; ++col) {
+        c[r * ldc + col] += spill[col];
+      }
+    }
+  }
+};
+
+#endif
+
+#if defined(__AVX2__)
+
+template <>
+struct GemmKernel<int32_t> {
+  static const size_t kRows = 4;
+  static const size_t kCols = 16;
+
+  static void Run(size_t kc, const int32_t* a_panel, const int32_t* b_panel,
+                  int32_t* c, size_t ldc, size_t rows, size_t cols) {
+    __m256i acc[kRows][2];
+    for (size_t r = 0; r < kRows; ++r) {
+      acc[r][0] = _mm256_setzero_si256();
+      acc[r][1] = _mm256_setzero_si256();
+    }
+    for (size_t p = 0; p < kc; ++p) {
+      const auto* b_row =
+          reinterpret_cast<const __m256i*>(b_panel + p * kCols);
+      __m256i b0 = _mm256_loadu_si256(b_row);
+      __m256i b1 = _mm256_loadu_si256(b_row + 1);
+#pragma GCC unroll 8
+      for (size_t r = 0; r < kRows; ++r) {
+        __m256i a = _mm256_set1_epi32(a_panel[p * kRows + r]);
+        acc[r][0] = _mm256_add_epi32(acc[r][0], _mm256_mullo_epi32(a, b0));
+        acc[r][1] = _mm256_add_epi32(acc[r][1], _mm256_mullo_epi32(a, b1));
+      }
+    }
+    alignas(32) int32_t spill[kCols];
+    for (size_t r = 0; r < rows; ++r) {
+      _mm256_store_si256(reinterpret_cast<__m256i*>(spill), acc[r][0]);
+      _mm256_store_si256(reinterpret_cast<__m256i*>(spill + 8), acc[r][1]);
+      for (size_t col = 0; col < cols; ++col) {
+        c[r * ldc + col] += spill[col];
+      }
+    }
+  }
+};
+
+#endif
+
+template <typename T>
+void GemmSimple(size_t n, size_t m, size_t k, const T* a, size_t lda,
+                const T* b, size_t ldb, T* c, size_t ldc) {
+  for (size_t i = 0; i < n; ++i) {
+    T* c_row = c + i * ldc;
+    for (size_t p = 0; p < k; ++p) {
+      const T& a_ip = a[i * lda + p];
+      const T* b_row = b + p * ldb;
+      for (size_t j = 0; j < m; ++j) {
+        c_row[j] += a_ip * b_row[j];
+      }
+    }
+  }
+}
+
+// Copies rows [0, mc) x columns [0, kc) of A into panels of kRows rows,
+// column by column, padding the last panel with zeros.
+template <typename T, size_t kRows>
+void GemmPackA(size_t mc, size_t kc, const T* a, size_t lda, T* packed) {
+  for (size_t ir = 0; ir < mc; ir += kRows) {
+    size_t rows = std::min(kRows, mc - ir);
+    for (size_t p = 0; p < kc; ++p) {
+      for (size_t r = 0; r < rows; ++r) {
+        packed[r] = a[(ir + r) * lda + p];
+      }
+      std::fill(packed + rows, packed + kRows, T());
+      packed += kRows;
+    }
+  }
+}
+
+// Copies rows [0, kc) x columns [0, nc) of B into panels of kCols columns,
+// row by row, padding the last panel with zeros.
+template <typename T, size_t kCols>
+void GemmPackB(size_t kc, size_t nc, const T* b, size_t ldb, T* packed) {
+  for (size_t jr = 0; jr < nc; jr += kCols) {
+    size_t cols = std::min(kCols, nc - jr);
+    for (size_t p = 0; p < kc; ++p) {
+      std::copy_n(b + p * ldb + jr, cols, packed);
+      std::fill(packed + cols, packed + kCols, T());
+      packed += kCols;
+    }
+  }
+}
+
+// Per-thread buffer for packed blocks of A, kept between calls.
+template <typename T>
+std::vector<T>& GemmPackedA() {
+  static thread_local std::vector<T> packed_a;
+  return packed_a;
+}
+
+template <typename T>
+void GemmBlocked(size_t n, size_t m, size_t k, const T* a, size_t lda,
+                 const T* b, size_t ldb, T* c, size_t ldc) {
+  using Kernel = GemmKernel<T>;
+  const size_t kRows = Kernel::kRows;
+  const size_t kCols = Kernel::kCols;
+
+  size_t block_n = std::min(kGemmBlockN, m);
+  size_t block_k = std::min(kGemmBlockK, k);
+  std::vector<T> packed_b((block_n + kCols - 1) / kCols * kCols * block_k);
+
+  for (size_t jc = 0; jc < m; jc += kGemmBlockN) {
+    size_t nc = std::min(kGemmBlockN, m - jc);
+    for (size_t pc = 0; pc < k; pc += kGemmBlockK) {
+      size_t kc = std::min(kGemmBlockK, k - pc);
+      GemmPackB<T, kCols>(kc, nc, b + pc * ldb + jc, ldb, packed_b.data());
+
+      size_t row_tiles = (n + kGemmBlockM - 1) / kGemmBlockM;
+      size_t col_tiles = (nc + kGemmTaskCols - 1) / kGemmTaskCols;
+      auto tile = [&](size_t task) {
+        size_t ic = task / col_tiles * kGemmBlockM;
+        size_t mc = std::min(kGemmBlockM, n - ic);
+        size_t jt = task % col_tiles * kGemmTaskCols;
+        size_t tc = std::min(kGemmTaskCols, nc - jt);
+
+        std::vector<T>& packed_a = GemmPackedA<T>();
+        packed_a.resize((mc + kRows - 1) / kRows * kRows * kc);
+        GemmPackA<T, kRows>(mc, kc, a + ic * lda + pc, lda, packed_a.data());
+        for (size_t jr = jt; jr < jt + tc; jr += kCols) {
+          for (size_t ir = 0; ir < mc; ir += kRows) {
+            Kernel::Run(kc, packed_a.data() + ir * kc,
+                        packed_b.data() + jr * kc,
+                        c + (ic + ir) * ldc + jc + jr, ldc,
+                        std::min(kRows, mc - ir),
+                        std::min(kCols, jt + tc - jr));
+          }
+        }
+      };
+      ThreadPool::Instance().ParallelFor(row_tiles * col_tiles, n * nc * kc,
+                                         tile);
+    }
+  }
+}
+
+template <typename T>
+void GemmDispatch(size_t n, size_t m, size_t k, const T* a, size_t lda,
+                  const T* b, size_t ldb, T* c, size_t ldc,
+                  std::true_type /*arithmetic*/) {
+  if (n * m * k < kGemmSmallVolume) {
+    GemmSimple(n, m, k, a, lda, b, ldb, c, ldc);
+    return;
+  }
+  GemmBlocked(n, m, k, a, lda, b, ldb, c, ldc);
+}
+
+template <typename T>
+void GemmDispatch(size_t n, size_t m, size_t k, const T* a, size_t lda,
+                  const T* b, size_t ldb, T* c, size_t ldc,
+                  std::false_type /*arithmetic*/) {
+  GemmSimple(n, m, k, a, lda, b, ldb, c, ldc);
+}
+
+template <typename T>
+void Gemm(size_t n, size_t m, size_t k, const T* a, size_t lda, const T* b,
+          size_t ldb, T* c, size_t ldc) {
+  GemmDispatch(n, m, k, a, lda, b, ldb, c, ldc, std::is_arithmetic<T>());
+}
@@ -0,0 +1,173 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include <vector>
+
+#include "matrix_view.hpp"
+
+// Columns factored per panel of the blocked LU; the trailing update of each
+// panel is one Gemm call.
+const size_t kLuBlock = 64;
+
+// In-place LU decomposition with partial pivoting of the square matrix a:
+// afterwards the strict lower triangle holds L (unit diagonal implied) and
+// the upper triangle U, with P * a = L * U where P swaps row k with row
+// pivots[k] for k = 0, 1, ... in order. Right-looking and blocked: a panel
+// of kLuBlock columns is factored, the matching block row of U is solved
+// for, and the trailing submatrix is updated with MultiplyAdd.
+// Returns false if a is singular.
+template <typename T>
+bool LuDecompose(const MatrixView<T>& a, std::vector<size_t>& pivots) {
+  size_t n = a.Rows();
+  pivots.resize(n);
+  bool regular = true;
+  std::vector<T> minus_l21;
+
+  for (size_t k0 = 0; k0 < n; k0 += kLuBlock) {
+    size_t kb = std::min(kLuBlock, n - k0);
+    size_t k1 = k0 + kb;
+
+    // Unblocked LU of the panel a[k0:n, k0:k1], swapping whole rows.
+    for (size_t k = k0; k < k1; ++k) {
+      size_t pivot = k;
+      for (size_t i = k + 1; i < n; ++i) {
+        if (std::abs(a(i, k)) > std::abs(a(pivot, k))) {
+          pivot = i;
+        }
+      }
+      pivots[k] = pivot;
+      if (a(pivot, k) == T()) {
+        // The column is already zero below the diagonal.
+        regular = false;
+        continue;
+      }
+      if (pivot != k) {
+        for (size_t j = 0; j < n; ++j) {
+          std::swap(a(k, j), a(pivot, j));
+        }
+      }
+      for (size_t i = k + 1; i < n; ++i) {
+        a(i, k) /= a(k, k);
+        const T& l_ik = a(i, k);
+        for (size_t j = k + 1; j < k1; ++j) {
+          a(i, j) -= l_ik * a(k, j);
+        }
+      }
+    }
+    if (k1 == n) {
+      break;
+    }
+
+    // U12 = L11^-1 * A12.
+    for (size_t k = k0; k < k1; ++k) {
+      for (size_t i = k + 1; i < k1; ++i) {
+        const T& l_ik = a(i, k);
+        for (size_t j = k1; j < n; ++j) {
+          a(i, j) -= l_ik * a(k, j);
+        }
+      }
+    }
+
+    // A22 -= L21 * U12.
+    size_t rest = n - k1;
+    minus_l21.resize(rest * kb);
+    for (size_t i = 0; i < rest; ++i) {
+      for (size_t j = 0; j < kb; ++j) {
+        minus_l21[i * kb + j] = -a(k1 + i, k0 + j);
+      }
+    }
+    MultiplyAdd(MatrixView<const T>(minus_l21.data(), rest, kb, kb),
+                MatrixView<const T>(a.Submatrix(k0, k1, kb, rest)),
+                a.Submatrix(k1, k1, rest, rest));
+  }
+  return regular;
+}
+
+// Solves (P^-1 * L * U) * x = b in place of b, for the output of a
+// successful LuDecompose. b may have several columns.
+template <typename T>
+void LuSolve(const MatrixView<const typename NonDeduced<T>::Type>& lu,
+             const std::vector<size_t>& pivots, const MatrixView<T>& b) {
+  size_t n = lu.Rows();
+  size_t cols = b.Cols();
+  for (size_t k = 0; k < n; ++k) {
+    if (pivots[k] != k) {
+      for (size_t j = 0; j < cols; ++j) {
+        std::swap(b(k, j), b(pivots[k], j));
+      }
+    }
+  }
+  for (size_t i = 0; i < n; ++i) {
+    for (size_t k = 0; k < i; ++k) {
+      const T& l_ik = lu(i, k);
+      for (size_t j = 0; j < cols; ++j) {
+        b(i, j) -= l_ik * b(k, j);
+      }
+    }
+  }
+  for (size_t i = n; i-- > 0;) {
+    for (size_t k = i + 1; k < n; ++k) {
+      const T& u_ik = lu(i, k);
+      for (size_t j = 0; j < cols; ++j) {
+        b(i, j) -= u_ik * b(k, j);
+      }
+    }
+    for (size_t j = 0; j < cols; ++j) {
+      b(i, j) /= lu(i, i);
+    }
+  }
+}
+
+// Determinant through LU, destroying a.
+template <typename T>
+T LuDeterminant(const MatrixView<T>& a) {
+  std::vector<size_t> pivots;
+  if (!LuDecompose(a, pivots)) {
+    return T();
+  }
+  T det = T(1);
+  for (size_t k = 0; k < a.Rows(); ++k) {
+    det *= a(k, k);
+    if (pivots[k] != k) {
+      det = -det;
+    }
+  }
+  return det;
+}
+
+// Fraction-free (Bareiss) elimination, destroying a. Every division is
+// exact, so the determinant is exact for integer types and BigInt, and
+// intermediate values stay bounded by minors of a.
+template <typename T>
+T BareissDeterminant(const MatrixView<T>& a) {
+  size_t n = a.Rows();
+  T previous = T(1);
+  bool negate = false;
+  for (size_t k = 0; k + 1 < n; ++k) {
+    if (a(k, k) == T()) {
+      size_t pivot = k + 1;
+      while (pivot < n && a(pivot, k) == T()) {
+        ++pivot;
+      }
+      if (pivot == n) {
+        return T();
+      }
+      for (size_t j = k; j < n; ++j) {
+        std::swap(a(k, j), a(pivot, j));
+      }
+      negate = !negate;
+    }
+    for (size_t i = k + 1; i < n; ++i) {
+      for (size_t j = k + 1; j < n; ++j) {
+        a(i, j) = (a(i, j) * a(k, k) - a(i, k) * a(k, j)) / previous;
+      }
+    }
+    previous = a(k, k);
+  }
+  if (n == 0) {
+    return T(1);
+  }
+  return negate ? -a(n - 1, n - 1) : a(n - 1, n - 1);
+}
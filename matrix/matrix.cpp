@@ -1 +1,7 @@
-#include "matrix.hpp"
\ No newline at end of file
+#include "matrix.hpp"
+
+#include "dynamic_matrix.hpp"
+#include "gemm.hpp"
+#include "lu.hpp"
+#include "matrix_view.hpp"
+#include "sparse_matrix.hpp"
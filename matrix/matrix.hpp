@@ -1,132 +1,396 @@
 #pragma once
 
 #include <algorithm>
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
-template <size_t N, size_t M, typename T = int64_t>
-class Matrix {
+#include "gemm.hpp"
+#include "lu.hpp"
+#include "matrix_expression.hpp"
+#include "matrix_view.hpp"
+#include "../thread_pool/thread_pool.hpp"
+
+// Elements are stored row-major in one contiguous block. Matrices of up to
+// kInlineMatrixBytes bytes keep it inside the object and never allocate,
+// larger ones keep it in a single heap block aligned to kMatrixAlignment.
+const size_t kInlineMatrixBytes = 512;
+const size_t kMatrixAlignment = 64;
+
+template <typename T, size_t Size>
+class InlineMatrixStorage {
 public:
-  // Constructors...
-  Matrix() { matrix_.resize(N, std::vector<T>(M, 0)); }
+  explicit InlineMatrixStorage(const T& elem) { elements_.fill(elem); }
 
-  Matrix(const Matrix<N, M, T>& copy) { this->matrix_ = copy.matrix_; }
+  T* Data() { return elements_.data(); }
+  const T* Data() const { return elements_.data(); }
 
-  Matrix<N, M, T>& operator=(const Matrix<N, M, T>& other) {
-    this->matrix_ = other.matrix_;
-    return *this;
-  }
+  void Swap(InlineMatrixStorage& other) { elements_.swap(other.elements_); }
 
-  Matrix(const T& elem) { matrix_.resize(N, std::vector<T>(M, elem)); }
+private:
+  std::array<T, Size> elements_;
+};
 
-  Matrix(std::vector<std::vector<T>>& vectors) { this->matrix_ = vectors; }
+template <typename T, size_t Size>
+class HeapMatrixStorage {
+public:
+  explicit HeapMatrixStorage(const T& elem) : elements_(Allocate()) {
+    std::uninitialized_fill_n(elements_, Size, elem);
+  }
 
-  ~Matrix() = default;
-  // Addition, subtraction, operators +=, -=.
-  // Addition and subtraction of matrices of inappropriate sizes should not be
-  // compiled.
-  // It is guaranteed that the types in the matrices in the tests will support
-  // the corresponding operations.
-  friend Matrix<N, M, T> operator+(const Matrix<N, M, T>& left,
-                                   const Matrix<N, M, T>& right) {
-    Matrix sum(left);
-    sum += right;
-    return sum;
+  HeapMatrixStorage(const HeapMatrixStorage& copy) : elements_(Allocate()) {
+    std::uninitialized_copy_n(copy.Data(), Size, elements_);
   }
-  friend Matrix<N, M, T> operator-(const Matrix<N, M, T>& left,
-                                   const Matrix<N, M, T>& right) {
-    Matrix diff(left);
-    diff -= right;
-    return diff;
+
+  // Takes over the block of other in O(1). The moved-from storage holds no
+  // block: it reads as T() elements (from a block shared by all moved-from
+  // storages of this type) and allocates its own on the first non-const
+  // access, so a moved-from Matrix keeps its size and is a zero matrix.
+  HeapMatrixStorage(HeapMatrixStorage&& other) noexcept
+      : elements_(other.elements_) {
+    other.elements_ = nullptr;
   }
 
-  Matrix<N, M, T>& operator+=(const Matrix<N, M, T>& other) {
-    for (size_t i = 0; i < N; ++i) {
-      for (size_t j = 0; j < M; ++j) {
-        this->matrix_[i][j] += other(i, j);
-      }
+  HeapMatrixStorage& operator=(const HeapMatrixStorage& other) {
+    if (this != &other) {
+      std::copy_n(other.Data(), Size, Data());
     }
     return *this;
   }
 
-  Matrix<N, M, T>& operator-=(const Matrix<N, M, T>& other) {
-    for (size_t i = 0; i < N; ++i) {
-      for (size_t j = 0; j < M; ++j) {
-        this->matrix_[i][j] -= other(i, j);
-      }
-    }
+  HeapMatrixStorage& operator=(HeapMatrixStorage&& other) noexcept {
+    Swap(other);
     return *this;
   }
 
-  // Multiplication by an element of type T (it is guaranteed that the *
-  // operator is defined for T)
-  friend Matrix<N, M, T> operator*(const Matrix<N, M, T>& matrix,
-                                   const T& number) {
-    Matrix mul(matrix);
-    for (std::vector<T>& row : mul.matrix_) {
-      for (T& elements : row) {
-        elements *= number;
-      }
+  ~HeapMatrixStorage() {
+    if (elements_ == nullptr) {
+      return;
     }
-    return mul;
+    std::destroy_n(elements_, Size);
+    ::operator delete(elements_, std::align_val_t(kMatrixAlignment));
+  }
+
+  T* Data() { return elements_ != nullptr ? elements_ : Refill(); }
+  const T* Data() const { return elements_ != nullptr ? elements_ : Zeros(); }
+
+  void Swap(HeapMatrixStorage& other) {
+    std::swap(elements_, other.elements_);
   }
-  friend Matrix<N, M, T> operator*(const T& number,
-                                   const Matrix<N, M, T>& matrix) {
-    return matrix * number;
+
+private:
+  T* elements_ = nullptr;
+
+  T* Refill() {
+    elements_ = Allocate();
+    std::uninitialized_fill_n(elements_, Size, T());
+    return elements_;
   }
 
-  // The Transposed() method, which returns the transposed matrix.
-  Matrix<M, N, T> Transposed() const {
-    Matrix<M, N, T> transposed_matrix;
+  // For arithmetic T the array is zero-initialized (in .bss, so untouched
+  // pages cost nothing) without a run-time guard, which lets the null check
+  // in Data() be hoisted out of elementwise loops. It is never written.
+  static const T* Zeros() {
+    static T zeros[Size] = {};
+    return zeros;
+  }
+
+  static T* Allocate() {
+    return static_cast<T*>(::operator new(
+        Size * sizeof(T), std::align_val_t(kMatrixAlignment)));
+  }
+};
+
+template <typename T, size_t Size>
+using MatrixStorage =
+    std::conditional_t<(Size * sizeof(T) <= kInlineMatrixBytes),
+                       InlineMatrixStorage<T, Size>,
+                       HeapMatrixStorage<T, Size>>;
+
+// Elementwise operations are split into blocks of whole rows of about this
+// many elements, which run in parallel on ThreadPool.
+const size_t kRowBlockElements = 1 << 14;
+
+// Calls function(begin, end) on flat index ranges covering whole rows of a
+// rows x cols matrix. Matrices too small to go parallel never touch the
+// pool.
+template <typename Function>
+void ForEachRowBlock(size_t rows, size_t cols, const Function& function) {
+  if (rows * cols < kParallelMinWork) {
+    function(0, rows * cols);
+    return;
+  }
+  size_t rows_per_block = std::max<size_t>(1, kRowBlockElements / cols);
+  size_t blocks = (rows + rows_per_block - 1) / rows_per_block;
+  ThreadPool::Instance().ParallelFor(blocks, rows * cols, [&](size_t block) {
+    size_t begin = block * rows_per_block;
+    size_t end = std::min(rows, begin + rows_per_block);
+    function(begin * cols, end * cols);
+  });
+}
+
+template <size_t N, size_t M, typename T = int64_t>
+class Matrix : public MatrixExpression<Matrix<N, M, T>, N, M, T> {
+public:
+  static const bool kFlat = true;
+
+  // Constructors...
+  Matrix() : elements_(T()) {}
+
+  Matrix(const T& elem) : elements_(elem) {}
+
+  Matrix(const std::vector<std::vector<T>>& vectors) : elements_(T()) {
     for (size_t i = 0; i < N; ++i) {
-      for (size_t j = 0; j < M; ++j) {
-        transposed_matrix(j, i) = this->matrix_[i][j];
-      }
+      std::copy_n(vectors[i].begin(), M, Data() + i * M);
     }
-    return transposed_matrix;
   }
 
-  // The Trace() method is to calculate the trace of the matrix.
+  // Evaluates an expression such as A + B - 2 * C.TransposedView() in one
+  // pass.
+  template <typename Expr>
+  Matrix(const MatrixExpression<Expr, N, M, T>& expr) : elements_(T()) {
+    Assign(expr.Self(), std::integral_constant<bool, Expr::kFlat>());
+  }
+
+  template <typename Expr>
+  Matrix<N, M, T>& operator=(const MatrixExpression<Expr, N, M, T>& expr) {
+    Assign(expr.Self(), std::integral_constant<bool, Expr::kFlat>());
+    return *this;
+  }
+
+  // Addition, subtraction, operators +=, -=. The binary operators and the
+  // multiplication by an element of type T are lazy, see
+  // matrix_expression.hpp.
+  template <typename Expr>
+  Matrix<N, M, T>& operator+=(const MatrixExpression<Expr, N, M, T>& other) {
+    return *this = *this + other;
+  }
+
+  template <typename Expr>
+  Matrix<N, M, T>& operator-=(const MatrixExpression<Expr, N, M, T>& other) {
+    return *this = *this - other;
+  }
+
+  // The Trace() method is to calculate the trace of the matrix. It only
+  // compiles for square matrices.
+  template <size_t K = N, typename = std::enable_if_t<K == M>>
   T Trace() const {
     T trace = 0;
     for (size_t i = 0; i < N; ++i) {
-      trace += matrix_[i][i];
+      trace += (*this)(i, i);
     }
 
     return trace;
   }
 
+  // The k-th power by binary exponentiation: O(log k) multiplications
+  // through three buffers that are reused for every squaring. Pow(0) is the
+  // identity. Only compiles for square matrices.
+  template <size_t K = N, typename = std::enable_if_t<K == M>>
+  Matrix Pow(uint64_t k) const {
+    auto multiply = [](const Matrix& left, const Matrix& right,
+                       Matrix& res) {
+      std::fill_n(res.Data(), N * M, T());
+      Gemm(N, N, N, left.Data(), N, right.Data(), N, res.Data(), N);
+    };
+    return PowWith(k, *this, T(1), multiply);
+  }
+
+  // The k-th power modulo modulus for integer T (including BigInt). Every
+  // product is reduced right away, so T only has to hold (modulus - 1)^2
+  // plus modulus. Elements are expected to be non-negative. Pow(0, modulus)
+  // is the identity reduced modulo modulus. Only compiles for square
+  // matrices of non-floating-point T.
+  template <size_t K = N,
+            typename = std::enable_if_t<K == M &&
+                                        !std::is_floating_point<T>::value>>
+  Matrix Pow(uint64_t k, const T& modulus) const {
+    Matrix base(*this);
+    for (size_t i = 0; i < N * M; ++i) {
+      base.Data()[i] %= modulus;
+    }
+    auto multiply = [&modulus](const Matrix& left, const Matrix& right,
+                               Matrix& res) {
+      std::fill_n(res.Data(), N * M, T());
+      for (size_t i = 0; i < N; ++i) {
+        for (size_t p = 0; p < N; ++p) {
+          const T& left_ip = left(i, p);
+          for (size_t j = 0; j < N; ++j) {
+            res(i, j) = (res(i, j) + left_ip * right(p, j) % modulus) % modulus;
+          }
+        }
+      }
+    };
+    return PowWith(k, base, T(1) % modulus, multiply);
+  }
+
+  // Determinant. Floating-point T uses the blocked LU decomposition from
+  // lu.hpp; other T (integers, BigInt) use exact fraction-free Bareiss
+  // elimination. Only compiles for square matrices.
+  template <size_t K = N, typename = std::enable_if_t<K == M>>
+  T Determinant() const {
+    Matrix copy(*this);
+    return DeterminantOf(copy.View(), std::is_floating_point<T>());
+  }
+
+  // x with (*this) * x == b, through LU with partial pivoting. Throws
+  // std::invalid_argument if the matrix is singular. Only compiles for
+  // square matrices of floating-point T.
+  template <size_t K, size_t Q = N,
+            typename = std::enable_if_t<Q == M &&
+                                        std::is_floating_point<T>::value>>
+  Matrix<N, K, T> Solve(const Matrix<N, K, T>& b) const {
+    Matrix lu(*this);
+    std::vector<size_t> pivots;
+    if (!LuDecompose(lu.View(), pivots)) {
+      throw std::invalid_argument("Matrix::Solve: singular matrix");
+    }
+    Matrix<N, K, T> x(b);
+    LuSolve(MatrixView<const T>(lu.View()), pivots, x.View());
+    return x;
+  }
+
+  template <size_t Q = N,
+            typename = std::enable_if_t<Q == M &&
+                                        std::is_floating_point<T>::value>>
+  Matrix Inverse() const {
+    Matrix identity;
+    for (size_t i = 0; i < N; ++i) {
+      identity(i, i) = T(1);
+    }
+    return Solve(identity);
+  }
+
   // Operator (i, j) that returns an element of the matrix in the i-th row and
   // in the j-th column. It is necessary to be able to change the value for
   // non-constant matrices.
   T& operator()(size_t index_i, size_t index_j) {
-    return this->matrix_[index_i][index_j];
+    return Data()[index_i * M + index_j];
   }
   const T& operator()(size_t index_i, size_t index_j) const {
-    return this->matrix_[index_i][index_j];
+    return Data()[index_i * M + index_j];
   }
 
-  // Equality check operator.
-  bool operator==(const Matrix& other) {
-    return this->matrix_ == other.matrix_;
+  const T& At(size_t index) const { return Data()[index]; }
+
+  bool Aliases(const T* data) const { return Data() == data; }
+
+  // Row-major elements: (i, j) is Data()[i * M + j].
+  T* Data() { return elements_.Data(); }
+  const T* Data() const { return elements_.Data(); }
+
+  // Strided view of the whole matrix, see matrix_view.hpp.
+  MatrixView<T> View() { return MatrixView<T>(Data(), N, M, M); }
+  MatrixView<const T> View() const {
+    return MatrixView<const T>(Data(), N, M, M);
   }
 
+  // O(1) for heap-allocated matrices.
+  void Swap(Matrix& other) { elements_.Swap(other.elements_); }
+
 private:
-  std::vector<std::vector<T>> matrix_;
-};
+  MatrixStorage<T, N * M> elements_;
 
-// Multiplication of two matrices. An attempt to multiply matrices of
-// inappropriate sizes should lead to a compilation error.
-template <size_t N, size_t M, size_t K, typename T = int64_t>
-Matrix<N, M, T> operator*(const Matrix<N, K, T>& left,
-                          const Matrix<K, M, T>& right) {
-  Matrix<N, M, T> res;
-  for (size_t index_x = 0; index_x < N; ++index_x) {
-    for (size_t index_y = 0; index_y < M; ++index_y) {
-      for (size_t index_z = 0; index_z < K; ++index_z) {
-        res(index_x, index_y) +=
-                left(index_x, index_z) * right(index_z, index_y);
+  static T DeterminantOf(const MatrixView<T>& copy,
+                         std::true_type /*floating point*/) {
+    return LuDeterminant(copy);
+  }
+
+  static T DeterminantOf(const MatrixView<T>& copy,
+                         std::false_type /*floating point*/) {
+    return BareissDeterminant(copy);
+  }
+
+  // multiply(left, right, res) must overwrite res with left * right; one is
+  // the diagonal of the identity returned for k == 0.
+  template <typename Multiply>
+  static Matrix PowWith(uint64_t k, Matrix base, const T& one,
+                        const Multiply& multiply) {
+    Matrix result;
+    Matrix temp;
+    bool result_is_identity = true;
+    while (k > 0) {
+      if ((k & 1) != 0) {
+        if (result_is_identity) {
+          result = base;
+          result_is_identity = false;
+        } else {
+          multiply(result, base, temp);
+          result.Swap(temp);
+        }
+      }
+      k >>= 1;
+      if (k > 0) {
+        multiply(base, base, temp);
+        base.Swap(temp);
       }
     }
+    if (result_is_identity) {
+      for (size_t i = 0; i < N; ++i) {
+        result(i, i) = one;
+      }
+    }
+    return result;
+  }
+
+  template <typename Expr>
+  void Assign(const Expr& expr, std::true_type /*flat*/) {
+    // Each element only depends on the same element of the operands, so
+    // this is safe even when expr reads *this.
+    T* elements = Data();
+    ForEachRowBlock(N, M, [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i) {
+        elements[i] = expr.At(i);
+      }
+    });
   }
+
+  template <typename Expr>
+  void Assign(const Expr& expr, std::false_type /*flat*/) {
+    if (expr.Aliases(Data())) {
+      // e.g. A = A.TransposedView() would read elements already
+      // overwritten.
+      Matrix temp(expr);
+      *this = std::move(temp);
+      return;
+    }
+    T* elements = Data();
+    ForEachRowBlock(N, M, [&](size_t begin, size_t end) {
+      for (size_t i = begin / M; i < end / M; ++i) {
+        for (size_t j = 0; j < M; ++j) {
+          elements[i * M + j] = expr(i, j);
+        }
+      }
+    });
+  }
+};
+
+template <size_t N, size_t M, typename T>
+const Matrix<N, M, T>& Evaluate(
+    const MatrixExpression<Matrix<N, M, T>, N, M, T>& matrix) {
+  return matrix.Self();
+}
+
+template <typename Expr, size_t N, size_t M, typename T>
+Matrix<N, M, T> Evaluate(const MatrixExpression<Expr, N, M, T>& expr) {
+  return Matrix<N, M, T>(expr);
+}
+
+// Multiplication of two matrices. An attempt to multiply matrices of
+// inappropriate sizes should lead to a compilation error. Operands that are
+// expressions are evaluated first.
+template <typename Left, typename Right, size_t N, size_t M, size_t K,
+          typename T>
+Matrix<N, M, T> operator*(const MatrixExpression<Left, N, K, T>& left,
+                          const MatrixExpression<Right, K, M, T>& right) {
+  const Matrix<N, K, T>& left_matrix = Evaluate(left);
+  const Matrix<K, M, T>& right_matrix = Evaluate(right);
+  Matrix<N, M, T> res;
+  Gemm(N, M, K, left_matrix.Data(), K, right_matrix.Data(), M, res.Data(), M);
   return res;
 }
@@ -0,0 +1,305 @@
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+// Lazy matrix arithmetic. +, - and scalar * build small expression objects
+// instead of matrices; the whole expression is evaluated element by element
+// in one loop when it is assigned to (or used to construct) a Matrix, so
+// A + B - 2 * C makes no intermediate matrices and reads each operand once.
+//
+// Expressions hold references to the Matrix lvalues they were built from,
+// so they must not outlive them. Matrix rvalues, such as the product in
+// (A * B) + C, are moved into the expression (see MatrixTemporary), so an
+// expression kept in an auto variable never refers to a dead temporary.
+
+template <size_t N, size_t M, typename T>
+class Matrix;
+
+template <typename Expr, size_t N, size_t M, typename T>
+class MatrixTranspose;
+
+template <typename Expr, size_t N, size_t M, typename T>
+class MatrixScaled;
+
+template <size_t N, size_t M, typename T>
+class MatrixTemporary;
+
+// Matrices are referenced, intermediate expressions are held by value.
+// Expressions own no matrix of their own except through MatrixTemporary,
+// which moves in O(1), so moving an expression never copies a matrix.
+template <typename Expr>
+struct MatrixOperand {
+  using Type = Expr;
+};
+
+template <size_t N, size_t M, typename T>
+struct MatrixOperand<Matrix<N, M, T>> {
+  using Type = const Matrix<N, M, T>&;
+};
+
+// How an rvalue operand is taken over by the expression built from it:
+// expressions are moved in, Matrix rvalues are wrapped in a MatrixTemporary.
+template <typename Expr>
+struct MatrixOwned {
+  using Type = Expr;
+
+  static Expr Take(Expr&& expr) { return std::move(expr); }
+};
+
+template <size_t N, size_t M, typename T>
+struct MatrixOwned<Matrix<N, M, T>> {
+  using Type = MatrixTemporary<N, M, T>;
+
+  static Type Take(Matrix<N, M, T>&& matrix) { return Type(std::move(matrix)); }
+};
+
+// CRTP base of Matrix and all expressions over N x M matrices of T.
+//
+// Every expression provides
+//   T operator()(i, j) const   - the element in row i, column j;
+//   bool Aliases(const T* data) const - whether it reads the matrix whose
+//                                elements start at data;
+//   static const bool kFlat    - whether it only combines same-position
+//                                elements of row-major matrices, in which
+//                                case it also provides T At(index) const
+//                                over the flat row-major index.
+template <typename Derived, size_t N, size_t M, typename T>
+class MatrixExpression {
+public:
+  const Derived& Self() const& { return static_cast<const Derived&>(*this); }
+  Derived&& Self() && { return static_cast<Derived&&>(*this); }
+
+  // The transposed matrix.
+  Matrix<M, N, T> Transposed() const {
+    return Matrix<M, N, T>(MatrixTranspose<Derived, N, M, T>(Self()));
+  }
+
+  // Zero-copy transposed view, evaluated when it is assigned.
+  MatrixTranspose<Derived, N, M, T> TransposedView() const& {
+    return MatrixTranspose<Derived, N, M, T>(Self());
+  }
+  MatrixTranspose<typename MatrixOwned<Derived>::Type, N, M, T>
+  TransposedView() && {
+    return MatrixTranspose<typename MatrixOwned<Derived>::Type, N, M, T>(
+        MatrixOwned<Derived>::Take(std::move(*this).Self()));
+  }
+
+  friend MatrixScaled<Derived, N, M, T> operator*(
+      const MatrixExpression& matrix, const T& number) {
+    return MatrixScaled<Derived, N, M, T>(matrix.Self(), number);
+  }
+  friend MatrixScaled<Derived, N, M, T> operator*(
+      const T& number, const MatrixExpression& matrix) {
+    return matrix * number;
+  }
+  friend MatrixScaled<typename MatrixOwned<Derived>::Type, N, M, T> operator*(
+      MatrixExpression&& matrix, const T& number) {
+    return MatrixScaled<typename MatrixOwned<Derived>::Type, N, M, T>(
+        MatrixOwned<Derived>::Take(std::move(matrix).Self()), number);
+  }
+  friend MatrixScaled<typename MatrixOwned<Derived>::Type, N, M, T> operator*(
+      const T& number, MatrixExpression&& matrix) {
+    return std::move(matrix) * number;
+  }
+};
+
+template <typename Left, typename Right, size_t N, size_t M, typename T>
+class MatrixSum : public MatrixExpression<MatrixSum<Left, Right, N, M, T>,
+                                          N, M, T> {
+public:
+  static const bool kFlat = Left::kFlat && Right::kFlat;
+
+  template <typename LeftArg, typename RightArg>
+  MatrixSum(LeftArg&& left, RightArg&& right)
+      : left_(std::forward<LeftArg>(left)),
+        right_(std::forward<RightArg>(right)) {}
+
+  T operator()(size_t index_i, size_t index_j) const {
+    return left_(index_i, index_j) + right_(index_i, index_j);
+  }
+  T At(size_t index) const { return left_.At(index) + right_.At(index); }
+
+  bool Aliases(const T* data) const {
+    return left_.Aliases(data) || right_.Aliases(data);
+  }
+
+private:
+  typename MatrixOperand<Left>::Type left_;
+  typename MatrixOperand<Right>::Type right_;
+};
+
+template <typename Left, typename Right, size_t N, size_t M, typename T>
+class MatrixDifference
+    : public MatrixExpression<MatrixDifference<Left, Right, N, M, T>, N, M,
+                              T> {
+public:
+  static const bool kFlat = Left::kFlat && Right::kFlat;
+
+  template <typename LeftArg, typename RightArg>
+  MatrixDifference(LeftArg&& left, RightArg&& right)
+      : left_(std::forward<LeftArg>(left)),
+        right_(std::forward<RightArg>(right)) {}
+
+  T operator()(size_t index_i, size_t index_j) const {
+    return left_(index_i, index_j) - right_(index_i, index_j);
+  }
+  T At(size_t index) const { return left_.At(index) - right_.At(index); }
+
+  bool Aliases(const T* data) const {
+    return left_.Aliases(data) || right_.Aliases(data);
+  }
+
+private:
+  typename MatrixOperand<Left>::Type left_;
+  typename MatrixOperand<Right>::Type right_;
+};
+
+template <typename Expr, size_t N, size_t M, typename T>
+class MatrixScaled
+    : public MatrixExpression<MatrixScaled<Expr, N, M, T>, N, M, T> {
+public:
+  static const bool kFlat = Expr::kFlat;
+
+  template <typename ExprArg>
+  MatrixScaled(ExprArg&& matrix, const T& number)
+      : matrix_(std::forward<ExprArg>(matrix)), number_(number) {}
+
+  T operator()(size_t index_i, size_t index_j) const {
+    return matrix_(index_i, index_j) * number_;
+  }
+  T At(size_t index) const { return matrix_.At(index) * number_; }
+
+  bool Aliases(const T* data) const { return matrix_.Aliases(data); }
+
+private:
+  typename MatrixOperand<Expr>::Type matrix_;
+  T number_;
+};
+
+// Transposed view of an N x M expression, itself an M x N expression.
+template <typename Expr, size_t N, size_t M, typename T>
+class MatrixTranspose
+    : public MatrixExpression<MatrixTranspose<Expr, N, M, T>, M, N, T> {
+public:
+  static const bool kFlat = false;
+
+  explicit MatrixTranspose(const Expr& matrix) : matrix_(matrix) {}
+  explicit MatrixTranspose(Expr&& matrix) : matrix_(std::move(matrix)) {}
+
+  T operator()(size_t index_i, size_t index_j) const {
+    return matrix_(index_j, index_i);
+  }
+
+  bool Aliases(const T* data) const { return matrix_.Aliases(data); }
+
+private:
+  typename MatrixOperand<Expr>::Type matrix_;
+};
+
+// Matrix operand that was an rvalue, owned by the expression instead of
+// referenced. Matrix is only complete where the expression is instantiated.
+template <size_t N, size_t M, typename T>
+class MatrixTemporary
+    : public MatrixExpression<MatrixTemporary<N, M, T>, N, M, T> {
+public:
+  static const bool kFlat = true;
+
+  explicit MatrixTemporary(Matrix<N, M, T>&& matrix)
+      : matrix_(std::move(matrix)) {}
+
+  T operator()(size_t index_i, size_t index_j) const {
+    return matrix_(index_i, index_j);
+  }
+  T At(size_t index) const { return matrix_.At(index); }
+
+  bool Aliases(const T* data) const { return matrix_.Aliases(data); }
+
+private:
+  Matrix<N, M, T> matrix_;
+};
+
+// Addition, subtraction. Addition and subtraction of matrices of
+// inappropriate sizes should not be compiled. The rvalue overloads move a
+// temporary operand into the expression.
+template <typename Left, typename Right, size_t N, size_t M, typename T>
+MatrixSum<Left, Right, N, M, T> operator+(
+    const MatrixExpression<Left, N, M, T>& left,
+    const MatrixExpression<Right, N, M, T>& right) {
+  return MatrixSum<Left, Right, N, M, T>(left.Self(), right.Self());
+}
+
+template <typename Left, typename Right, size_t N, size_t M, typename T>
+MatrixSum<typename MatrixOwned<Left>::Type, Right, N, M, T> operator+(
+    MatrixExpression<Left, N, M, T>&& left,
+    const MatrixExpression<Right, N, M, T>& right) {
+  return MatrixSum<typename MatrixOwned<Left>::Type, Right, N, M, T>(
+      MatrixOwned<Left>::Take(std::move(left).Self()), right.Self());
+}
+
+template <typename Left, typename Right, size_t N, size_t M, typename T>
+MatrixSum<Left, typename MatrixOwned<Right>::Type, N, M, T> operator+(
+    const MatrixExpression<Left, N, M, T>& left,
+    MatrixExpression<Right, N, M, T>&& right) {
+  return MatrixSum<Left, typename MatrixOwned<Right>::Type, N, M, T>(
+      left.Self(), MatrixOwned<Right>::Take(std::move(right).Self()));
+}
+
+template <typename Left, typename Right, size_t N, size_t M, typename T>
+MatrixSum<typename MatrixOwned<Left>::Type,
+          typename MatrixOwned<Right>::Type, N, M, T>
+operator+(MatrixExpression<Left, N, M, T>&& left,
+          MatrixExpression<Right, N, M, T>&& right) {
+  return MatrixSum<typename MatrixOwned<Left>::Type,
+                   typename MatrixOwned<Right>::Type, N, M, T>(
+      MatrixOwned<Left>::Take(std::move(left).Self()),
+      MatrixOwned<Right>::Take(std::move(right).Self()));
+}
+
+template <typename Left, typename Right, size_t N, size_t M, typename T>
+MatrixDifference<Left, Right, N, M, T> operator-(
+    const MatrixExpression<Left, N, M, T>& left,
+    const MatrixExpression<Right, N, M, T>& right) {
+  return MatrixDifference<Left, Right, N, M, T>(left.Self(), right.Self());
+}
+
+template <typename Left, typename Right, size_t N, size_t M, typename T>
+MatrixDifference<typename MatrixOwned<Left>::Type, Right, N, M, T> operator-(
+    MatrixExpression<Left, N, M, T>&& left,
+    const MatrixExpression<Right, N, M, T>& right) {
+  return MatrixDifference<typename MatrixOwned<Left>::Type, Right, N, M, T>(
+      MatrixOwned<Left>::Take(std::move(left).Self()), right.Self());
+}
+
+template <typename Left, typename Right, size_t N, size_t M, typename T>
+MatrixDifference<Left, typename MatrixOwned<Right>::Type, N, M, T> operator-(
+    const MatrixExpression<Left, N, M, T>& left,
+    MatrixExpression<Right, N, M, T>&& right) {
+  return MatrixDifference<Left, typename MatrixOwned<Right>::Type, N, M, T>(
+      left.Self(), MatrixOwned<Right>::Take(std::move(right).Self()));
+}
+
+template <typename Left, typename Right, size_t N, size_t M, typename T>
+MatrixDifference<typename MatrixOwned<Left>::Type,
+                 typename MatrixOwned<Right>::Type, N, M, T>
+operator-(MatrixExpression<Left, N, M, T>&& left,
+          MatrixExpression<Right, N, M, T>&& right) {
+  return MatrixDifference<typename MatrixOwned<Left>::Type,
+                          typename MatrixOwned<Right>::Type, N, M, T>(
+      MatrixOwned<Left>::Take(std::move(left).Self()),
+      MatrixOwned<Right>::Take(std::move(right).Self()));
+}
+
+template <typename Left, typename Right, size_t N, size_t M, typename T>
+bool operator==(const MatrixExpression<Left, N, M, T>& left,
+                const MatrixExpression<Right, N, M, T>& right) {
+  for (size_t i = 0; i < N; ++i) {
+    for (size_t j = 0; j < M; ++j) {
+      if (!(left.Self()(i, j) == right.Self()(i, j))) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
@@ -0,0 +1,153 @@
+#pragma once
+
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include "gemm.hpp"
+
+// Non-owning strided window into a matrix: element (i, j) lives at
+// Data()[i * RowStride() + j * ColStride()]. Submatrices, single rows and
+// columns and transposes are views of the same memory, so blocked
+// algorithms can work on parts of a matrix without copying it. A view must
+// not outlive the matrix it points into. MatrixView<const T> is read-only.
+template <typename T>
+class MatrixView {
+public:
+  MatrixView(T* data, size_t rows, size_t cols, size_t row_stride,
+             size_t col_stride = 1)
+      : data_(data),
+        rows_(rows),
+        cols_(cols),
+        row_stride_(row_stride),
+        col_stride_(col_stride) {}
+
+  // MatrixView<T> converts to MatrixView<const T>.
+  template <typename U,
+            typename = std::enable_if_t<std::is_same<const U, T>::value &&
+                                        !std::is_same<U, T>::value>>
+  MatrixView(const MatrixView<U>& view)
+      : MatrixView(view.Data(), view.Rows(), view.Cols(), view.RowStride(),
+                   view.ColStride()) {}
+
+  size_t Rows() const { return rows_; }
+  size_t Cols() const { return cols_; }
+  size_t RowStride() const { return row_stride_; }
+  size_t ColStride() const { return col_stride_; }
+  T* Data() const { return data_; }
+
+  T& operator()(size_t index_i, size_t index_j) const {
+    return data_[index_i * row_stride_ + index_j * col_stride_];
+  }
+
+  MatrixView Submatrix(size_t row, size_t col, size_t rows,
+                       size_t cols) const {
+    if (row + rows > rows_ || col + cols > cols_) {
+      throw std::out_of_range("MatrixView::Submatrix: out of bounds");
+    }
+    return MatrixView(&(*this)(row, col), rows, cols, row_stride_,
+                      col_stride_);
+  }
+
+  MatrixView Row(size_t index) const { return Submatrix(index, 0, 1, cols_); }
+
+  MatrixView Col(size_t index) const { return Submatrix(0, index, rows_, 1); }
+
+  MatrixView Transposed() const {
+    return MatrixView(data_, cols_, rows_, col_stride_, row_stride_);
+  }
+
+  // Elementwise updates from a view of the same shape.
+  const MatrixView& operator+=(const MatrixView<const T>& other) const {
+    CheckSameShape(other);
+    for (size_t i = 0; i < rows_; ++i) {
+      for (size_t j = 0; j < cols_; ++j) {
+        (*this)(i, j) += other(i, j);
+      }
+    }
+    return *this;
+  }
+
+  const MatrixView& operator-=(const MatrixView<const T>& other) const {
+    CheckSameShape(other);
+    for (size_t i = 0; i < rows_; ++i) {
+      for (size_t j = 0; j < cols_; ++j) {
+        (*this)(i, j) -= other(i, j);
+      }
+    }
+    return *this;
+  }
+
+  void CopyFrom(const MatrixView<const T>& other) const {
+    CheckSameShape(other);
+    for (size_t i = 0; i < rows_; ++i) {
+      for (size_t j = 0; j < cols_; ++j) {
+        (*this)(i, j) = other(i, j);
+      }
+    }
+  }
+
+private:
+  T* data_;
+  size_t rows_;
+  size_t cols_;
+  size_t row_stride_;
+  size_t col_stride_;
+
+  void CheckSameShape(const MatrixView<const T>& other) const {
+    if (other.Rows() != rows_ || other.Cols() != cols_) {
+      throw std::invalid_argument("MatrixView: shapes differ");
+    }
+  }
+};
+
+// Copies a view whose columns are not adjacent into a row-major buffer.
+template <typename T>
+const T* RowMajor(const MatrixView<const T>& view, std::vector<T>& buffer,
+                  size_t& leading_dimension) {
+  if (view.ColStride() == 1) {
+    leading_dimension = view.RowStride();
+    return view.Data();
+  }
+  buffer.resize(view.Rows() * view.Cols());
+  for (size_t i = 0; i < view.Rows(); ++i) {
+    for (size_t j = 0; j < view.Cols(); ++j) {
+      buffer[i * view.Cols() + j] = view(i, j);
+    }
+  }
+  leading_dimension = view.Cols();
+  return buffer.data();
+}
+
+template <typename T>
+struct NonDeduced {
+  using Type = T;
+};
+
+// res += left * right on views, through Gemm. Operands that are column
+// views or transposes are packed into row-major order first.
+template <typename T>
+void MultiplyAdd(const MatrixView<const typename NonDeduced<T>::Type>& left,
+                 const MatrixView<const typename NonDeduced<T>::Type>& right,
+                 const MatrixView<T>& res) {
+  if (left.Cols() != right.Rows() || res.Rows() != left.Rows() ||
+      res.Cols() != right.Cols()) {
+    throw std::invalid_argument("MultiplyAdd: shapes do not match");
+  }
+  std::vector<T> left_buffer;
+  std::vector<T> right_buffer;
+  size_t lda = 0;
+  size_t ldb = 0;
+  const T* left_data = RowMajor(left, left_buffer, lda);
+  const T* right_data = RowMajor(right, right_buffer, ldb);
+  if (res.ColStride() == 1) {
+    Gemm(left.Rows(), right.Cols(), left.Cols(), left_data, lda, right_data,
+         ldb, res.Data(), res.RowStride());
+    return;
+  }
+  std::vector<T> res_buffer(res.Rows() * res.Cols());
+  Gemm(left.Rows(), right.Cols(), left.Cols(), left_data, lda, right_data,
+       ldb, res_buffer.data(), res.Cols());
+  res += MatrixView<const T>(res_buffer.data(), res.Rows(), res.Cols(),
+                             res.Cols());
+}
@@ -0,0 +1,255 @@
+#pragma once
+
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+#include "matrix.hpp"
+#include "../thread_pool/thread_pool.hpp"
+
+// Rows of a sparse operand handled by one parallel task.
+const size_t kSparseRowsPerTask = 256;
+
+template <typename T>
+struct Triplet {
+  size_t row;
+  size_t col;
+  T value;
+};
+
+template <size_t N, size_t M, typename T>
+class SparseMatrixCsc;
+
+// Compressed sparse row matrix with the same compile-time dimensions as
+// Matrix. Row i holds the columns Columns()[RowOffsets()[i] ..
+// RowOffsets()[i + 1]) in increasing order with the matching Values().
+// Elements equal to T() are never stored.
+template <size_t N, size_t M, typename T = int64_t>
+class SparseMatrix {
+public:
+  SparseMatrix() : row_offsets_(N + 1, 0) {}
+
+  explicit SparseMatrix(const Matrix<N, M, T>& dense) {
+    row_offsets_.reserve(N + 1);
+    row_offsets_.push_back(0);
+    for (size_t i = 0; i < N; ++i) {
+      for (size_t j = 0; j < M; ++j) {
+        if (!(dense(i, j) == T())) {
+          columns_.push_back(j);
+          values_.push_back(dense(i, j));
+        }
+      }
+      row_offsets_.push_back(columns_.size());
+    }
+  }
+
+  // Triplets may come in any order; repeated positions are summed. Throws
+  // std::out_of_range if a triplet lies outside the N x M matrix.
+  explicit SparseMatrix(const std::vector<Triplet<T>>& triplets)
+      : row_offsets_(N + 1, 0) {
+    for (const Triplet<T>& triplet : triplets) {
+      if (triplet.row >= N || triplet.col >= M) {
+        throw std::out_of_range("SparseMatrix: triplet out of bounds");
+      }
+    }
+    std::vector<Triplet<T>> sorted(triplets);
+    std::sort(sorted.begin(), sorted.end(),
+              [](const Triplet<T>& left, const Triplet<T>& right) {
+                return left.row < right.row ||
+                       (left.row == right.row && left.col < right.col);
+              });
+    for (size_t i = 0; i < sorted.size();) {
+      T value = sorted[i].value;
+      size_t next = i + 1;
+      for (; next < sorted.size() && sorted[next].row == sorted[i].row &&
+             sorted[next].col == sorted[i].col;
+           ++next) {
+        value += sorted[next].value;
+      }
+      if (!(value == T())) {
+        columns_.push_back(sorted[i].col);
+        values_.push_back(value);
+        ++row_offsets_[sorted[i].row + 1];
+      }
+      i = next;
+    }
+    for (size_t i = 0; i < N; ++i) {
+      row_offsets_[i + 1] += row_offsets_[i];
+    }
+  }
+
+  size_t NonZeros() const { return values_.size(); }
+
+  // O(log of the row length).
+  T operator()(size_t index_i, size_t index_j) const {
+    auto begin = columns_.begin() + row_offsets_[index_i];
+    auto end = columns_.begin() + row_offsets_[index_i + 1];
+    auto found = std::lower_bound(begin, end, index_j);
+    if (found == end || *found != index_j) {
+      return T();
+    }
+    return values_[found - columns_.begin()];
+  }
+
+  Matrix<N, M, T> ToDense() const {
+    Matrix<N, M, T> dense;
+    for (size_t i = 0; i < N; ++i) {
+      for (size_t k = row_offsets_[i]; k < row_offsets_[i + 1]; ++k) {
+        dense(i, columns_[k]) = values_[k];
+      }
+    }
+    return dense;
+  }
+
+  // The same storage read by columns is the CSR form of the transpose.
+  SparseMatrix<M, N, T> Transposed() const {
+    SparseMatrix<M, N, T> transposed;
+    Compress(N, M, row_offsets_, columns_, values_,
+             transposed.row_offsets_, transposed.columns_,
+             transposed.values_);
+    return transposed;
+  }
+
+  SparseMatrixCsc<N, M, T> ToCsc() const {
+    return SparseMatrixCsc<N, M, T>(Transposed());
+  }
+
+  const std::vector<size_t>& RowOffsets() const { return row_offsets_; }
+  const std::vector<size_t>& Columns() const { return columns_; }
+  const std::vector<T>& Values() const { return values_; }
+
+private:
+  template <size_t, size_t, typename>
+  friend class SparseMatrix;
+
+  std::vector<size_t> row_offsets_;
+  std::vector<size_t> columns_;
+  std::vector<T> values_;
+
+  // Counting sort of a compressed rows x cols matrix by column, giving the
+  // compressed form of its transpose. Indices stay sorted within a line.
+  static void Compress(size_t rows, size_t cols,
+                       const std::vector<size_t>& offsets,
+                       const std::vector<size_t>& indices,
+                       const std::vector<T>& values,
+                       std::vector<size_t>& out_offsets,
+                       std::vector<size_t>& out_indices,
+                       std::vector<T>& out_values) {
+    out_offsets.assign(cols + 1, 0);
+    for (size_t index : indices) {
+      ++out_offsets[index + 1];
+    }
+    for (size_t j = 0; j < cols; ++j) {
+      out_offsets[j + 1] += out_offsets[j];
+    }
+    out_indices.resize(indices.size());
+    out_values.resize(values.size());
+    std::vector<size_t> next(out_offsets.begin(), out_offsets.end() - 1);
+    for (size_t i = 0; i < rows; ++i) {
+      for (size_t k = offsets[i]; k < offsets[i + 1]; ++k) {
+        size_t position = next[indices[k]]++;
+        out_indices[position] = i;
+        out_values[position] = values[k];
+      }
+    }
+  }
+};
+
+// Compressed sparse column form of an N x M matrix: column j holds the rows
+// Rows()[ColOffsets()[j] .. ColOffsets()[j + 1]) in increasing order.
+template <size_t N, size_t M, typename T = int64_t>
+class SparseMatrixCsc {
+public:
+  SparseMatrixCsc() = default;
+
+  // Built from the CSR form of the transpose, which has the same arrays.
+  explicit SparseMatrixCsc(const SparseMatrix<M, N, T>& transposed)
+      : transposed_(transposed) {}
+
+  size_t NonZeros() const { return transposed_.NonZeros(); }
+
+  T operator()(size_t index_i, size_t index_j) const {
+    return transposed_(index_j, index_i);
+  }
+
+  SparseMatrix<N, M, T> ToCsr() const { return transposed_.Transposed(); }
+
+  const std::vector<size_t>& ColOffsets() const {
+    return transposed_.RowOffsets();
+  }
+  const std::vector<size_t>& Rows() const { return transposed_.Columns(); }
+  const std::vector<T>& Values() const { return transposed_.Values(); }
+
+private:
+  SparseMatrix<M, N, T> transposed_;
+};
+
+// Sparse x dense. Each row of the result is a sum of scaled rows of the
+// dense operand, a contiguous loop the compiler vectorizes; for a single
+// column (SpMV) it is a plain dot product. Row blocks run on ThreadPool.
+template <typename Expr, size_t N, size_t M, size_t K, typename T>
+Matrix<N, K, T> operator*(const SparseMatrix<N, M, T>& left,
+                          const MatrixExpression<Expr, M, K, T>& right) {
+  const Matrix<M, K, T>& right_matrix = Evaluate(right);
+  const T* dense = right_matrix.Data();
+  const size_t* offsets = left.RowOffsets().data();
+  const size_t* columns = left.Columns().data();
+  const T* values = left.Values().data();
+
+  Matrix<N, K, T> res;
+  T* res_data = res.Data();
+  size_t tasks = (N + kSparseRowsPerTask - 1) / kSparseRowsPerTask;
+  ThreadPool::Instance().ParallelFor(
+      tasks, left.NonZeros() * K, [&](size_t task) {
+        size_t end = std::min(N, (task + 1) * kSparseRowsPerTask);
+        for (size_t i = task * kSparseRowsPerTask; i < end; ++i) {
+          if (K == 1) {
+            T sum = T();
+            for (size_t k = offsets[i]; k < offsets[i + 1]; ++k) {
+              sum += values[k] * dense[columns[k]];
+            }
+            res_data[i] = sum;
+            continue;
+          }
+          T* res_row = res_data + i * K;
+          for (size_t k = offsets[i]; k < offsets[i + 1]; ++k) {
+            const T& value = values[k];
+            const T* dense_row = dense + columns[k] * K;
+            for (size_t j = 0; j < K; ++j) {
+              res_row[j] += value * dense_row[j];
+            }
+          }
+        }
+      });
+  return res;
+}
+
+// Dense x sparse: row i of the result accumulates left(i, p) times row p of
+// the sparse operand.
+template <typename Expr, size_t N, size_t M, size_t K, typename T>
+Matrix<N, K, T> operator*(const MatrixExpression<Expr, N, M, T>& left,
+                          const SparseMatrix<M, K, T>& right) {
+  const Matrix<N, M, T>& left_matrix = Evaluate(left);
+  const size_t* offsets = right.RowOffsets().data();
+  const size_t* columns = right.Columns().data();
+  const T* values = right.Values().data();
+
+  Matrix<N, K, T> res;
+  size_t tasks = (N + kSparseRowsPerTask - 1) / kSparseRowsPerTask;
+  ThreadPool::Instance().ParallelFor(
+      tasks, N * right.NonZeros(), [&](size_t task) {
+        size_t end = std::min(N, (task + 1) * kSparseRowsPerTask);
+        for (size_t i = task * kSparseRowsPerTask; i < end; ++i) {
+          for (size_t p = 0; p < M; ++p) {
+            const T& left_ip = left_matrix(i, p);
+            if (left_ip == T()) {
+              continue;
+            }
+            for (size_t k = offsets[p]; k < offsets[p + 1]; ++k) {
+              res(i, columns[k]) += left_ip * values[k];
+            }
+          }
+        }
+      });
+  return res;
+}
@@ -0,0 +1,159 @@
+#include "mapped_string.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+#include "../thread_pool/thread_pool.hpp"
+
+MappedString::MappedString() {}
+
+MappedString MappedString::Open(const char* path) {
+  MappedString mapped;
+  int fd = open(path, O_RDONLY);
+  if (fd < 0) {
+    return mapped;
+  }
+
+  struct stat info;
+  if (fstat(fd, &info) != 0) {
+    close(fd);
+    return mapped;
+  }
+
+  size_t size = static_cast<size_t>(info.st_size);
+  if (size != 0) {
+    void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED) {
+      close(fd);
+      return mapped;
+    }
+    madvise(data, size, MADV_SEQUENTIAL);
+    mapped.characters_ = static_cast<const char*>(data);
+    mapped.string_size_ = size;
+  }
+  // The mapping keeps the file referenced, the descriptor is not needed.
+  close(fd);
+  mapped.is_open_ = true;
+  return mapped;
+}
+
+MappedString::MappedString(MappedString&& other) noexcept { Swap(other); }
+
+MappedString& MappedString::operator=(MappedString&& other) noexcept {
+  MappedString temp(std::move(other));
+  Swap(temp);
+  return *this;
+}
+
+MappedString::~MappedString() {
+  if (characters_ != nullptr) {
+    munmap(const_cast<char*>(characters_), string_size_);
+  }
+}
+
+bool MappedString::IsOpen() const { return is_open_; }
+
+bool MappedString::Empty() const { return string_size_ == 0; }
+
+size_t MappedString::Size() const { return string_size_; }
+
+const char* MappedString::Data() const { return characters_; }
+
+const char& MappedString::operator[](size_t i) const { return characters_[i]; }
+
+StringView MappedString::View() const { return {characters_, string_size_}; }
+
+void MappedString::Swap(MappedString& other) {
+  std::swap(characters_, other.characters_);
+  std::swap(string_size_, other.string_size_);
+  std::swap(is_open_, other.is_open_);
+}
+
+namespace {
+
+// Chunks smaller than this are not worth a task.
+const size_t kMinChunkSize = 1 << 16;
+
+bool HasBorder(const StringView& delim) {
+  for (size_t len = 1; len < delim.Size(); ++len) {
+    if (std::memcmp(delim.Data(), delim.Data() + delim.Size() - len, len) ==
+        0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Position right after the first occurrence of delim at or after from, or
+// text.Size() if there is none.
+size_t NextCut(const StringView& text, const StringView& delim, size_t from) {
+  while (from < text.Size() && text.Size() - from >= delim.Size()) {
+    const void* found = std::memchr(text.Data() + from, delim[0],
+                                    text.Size() - from - delim.Size() + 1);
+    if (found == nullptr) {
+      break;
+    }
+    size_t pos = static_cast<const char*>(found) - text.Data();
+    if (std::memcmp(text.Data() + pos, delim.Data(), delim.Size()) == 0) {
+      return pos + delim.Size();
+    }
+    from = pos + 1;
+  }
+  return text.Size();
+}
+
+}  // namespace
+
+std::vector<StringView> SplitParallel(const StringView& text,
+                                      const StringView& delim /*= " "*/,
+                                      size_t chunks /*= 0*/) {
+  if (chunks == 0) {
+    chunks = ThreadPool::Instance().ThreadCount();
+  }
+  if (text.Size() / kMinChunkSize < chunks) {
+    chunks = text.Size() / kMinChunkSize;
+  }
+  if (chunks <= 1 || delim.Empty() || HasBorder(delim)) {
+    return text.Split(delim);
+  }
+
+  // Every chunk but the last ends right after a delimiter.
+  std::vector<size_t> cuts(1, 0);
+  for (size_t i = 1; i < chunks; ++i) {
+    size_t nominal = text.Size() / chunks * i;
+    size_t cut = NextCut(text, delim, std::max(nominal, cuts.back()));
+    if (cut == text.Size()) {
+      break;
+    }
+    cuts.push_back(cut);
+  }
+  cuts.push_back(text.Size());
+  chunks = cuts.size() - 1;
+
+  std::vector<std::vector<StringView>> parts(chunks);
+  ThreadPool::Instance().ParallelFor(chunks, text.Size(), [&](size_t i) {
+    parts[i] = text.Substr(cuts[i], cuts[i + 1] - cuts[i]).Split(delim);
+    if (i + 1 < chunks) {
+      // The trailing empty piece after the closing delimiter belongs to the
+      // next chunk.
+      parts[i].pop_back();
+    }
+  });
+
+  size_t total = 0;
+  for (const auto& part : parts) {
+    total += part.size();
+  }
+  std::vector<StringView> split_elems;
+  split_elems.reserve(total);
+  for (const auto& part : parts) {
+    split_elems.insert(split_elems.end(), part.begin(), part.end());
+  }
+  return split_elems;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <vector>
+
+#include "string.hpp"
+
+// Read-only memory mapping of a whole file. The contents are exposed without
+// copying, so the views produced by SplitParallel point straight into the
+// page cache and stay valid for as long as the mapping is alive.
+class MappedString {
+public:
+  MappedString();
+
+  // Maps the file at path. On failure the result is not open (IsOpen() is
+  // false) and behaves as an empty string.
+  static MappedString Open(const char* path);
+
+  MappedString(const MappedString&) = delete;
+
+  MappedString& operator=(const MappedString&) = delete;
+
+  MappedString(MappedString&& other) noexcept;
+
+  MappedString& operator=(MappedString&& other) noexcept;
+
+  ~MappedString();
+
+  bool IsOpen() const;
+
+  bool Empty() const;
+
+  size_t Size() const;
+
+  const char* Data() const;
+
+  const char& operator[](size_t i) const;
+
+  StringView View() const;
+
+  void Swap(MappedString& other);
+
+private:
+  const char* characters_ = nullptr;
+  size_t string_size_ = 0;
+  bool is_open_ = false;
+};
+
+// Splits text by delim like String::Split, cutting it into chunks at
+// delimiter boundaries and tokenizing the chunks as ThreadPool tasks.
+// chunks == 0 means one per ThreadPool thread, so the split stays serial
+// until ThreadPool::SetThreadCount() is called. Delimiters that can overlap
+// themselves (e.g. "aa") are split sequentially, because a chunk boundary
+// found mid-text could disagree with the left-to-right scan.
+std::vector<StringView> SplitParallel(const StringView& text,
+                                      const StringView& delim = " ",
+                                      size_t chunks = 0);
@@ -2,40 +2,78 @@
 
 String::String() {}
 
-String::String(size_t size, char character) {
+String::String(std::pmr::memory_resource* resource) : resource_(resource) {}
+
+String::String(size_t size, char character,
+               std::pmr::memory_resource* resource)
+    : resource_(resource) {
   memory_used_ = size + 1;
   capacity_ = size;
   string_size_ = size;
-  characters_ = new char[memory_used_];
+  characters_ = static_cast<char*>(resource_->allocate(memory_used_, 1));
   std::memset(characters_, character, string_size_);
   characters_[string_size_] = '\0';
 }
 
-String::String(const char* str) {
+String::String(const char* str, std::pmr::memory_resource* resource)
+    : resource_(resource) {
   string_size_ = std::strlen(str);
   capacity_ = string_size_;
   memory_used_ = capacity_ + 1;
-  characters_ = new char[memory_used_];
+  characters_ = static_cast<char*>(resource_->allocate(memory_used_, 1));
   std::memcpy(characters_, str, string_size_);
   characters_[string_size_] = '\0';
 }
 
-String::String(const String& copy) {
+String::String(const String& copy, std::pmr::memory_resource* resource)
+    : resource_(resource) {
+  if (copy.Data() == nullptr) {
+    return;
+  }
   string_size_ = copy.string_size_;
   capacity_ = string_size_;
   memory_used_ = string_size_ + 1;
-  characters_ = new char[memory_used_];
+  characters_ = static_cast<char*>(resource_->allocate(memory_used_, 1));
   std::memcpy(characters_, copy.Data(), memory_used_);
 }
 
+String::String(String&& other) noexcept : resource_(other.resource_) {
+  Swap(other);
+}
+
 String& String::operator=(const String& str) {
-  String temp_string(str);
+  String temp_string(str, resource_);
   Swap(temp_string);
 
   return *this;
 }
 
-String::~String() { delete[] characters_; }
+String& String::operator=(String&& str) {
+  if (resource_ != str.resource_ && !resource_->is_equal(*str.resource_)) {
+    return *this = str;
+  }
+  String temp_string(std::move(str));
+  Swap(temp_string);
+
+  return *this;
+}
+
+String::~String() {
+  if (characters_ != nullptr) {
+    resource_->deallocate(characters_, memory_used_, 1);
+  }
+}
+
+void String::Reallocate(size_t memory_used) {
+  char* temp = static_cast<char*>(resource_->allocate(memory_used, 1));
+
+  if (Data() != nullptr) {
+    std::memcpy(temp, Data(), Size() + 1);
+    resource_->deallocate(characters_, memory_used_, 1);
+  }
+  characters_ = temp;
+  memory_used_ = memory_used;
+}
 
 void String::Clear() {
   string_size_ = 0;
@@ -61,15 +99,7 @@ void String::Resize(size_t new_size) {
     return;
   }
 
-  memory_used_ = 2 * new_size;
-  char* temp = new char[memory_used_];
-
-  if (Data() != nullptr) {
-    std::memcpy(temp, Data(), Size() + 1);
-  }
-
-  delete[] characters_;
-  characters_ = temp;
+  Reallocate(2 * new_size);
   string_size_ = new_size;
   capacity_ = memory_used_ - 1;
 }
@@ -85,27 +115,16 @@ void String::Reserve(size_t new_cap) {
     return;
   }
 
+  Reallocate(new_cap + 1);
   capacity_ = new_cap;
-  memory_used_ = new_cap + 1;
-  char* temp = new char[memory_used_];
-
-  if (Data() != nullptr) {
-    std::memcpy(temp, Data(), Size() + 1);
-  }
-  delete[] characters_;
-  characters_ = temp;
 }
 
 void String::ShrinkToFit() {
   if (capacity_ == string_size_) {
     return;
   }
-  char* temp = new char[string_size_ + 1];
-  std::memcpy(temp, Data(), Size() + 1);
-  delete[] characters_;
-  characters_ = temp;
+  Reallocate(string_size_ + 1);
   capacity_ = string_size_;
-  memory_used_ = capacity_ + 1;
 }
 
 void String::Swap(String& other) {
@@ -113,6 +132,7 @@ void String::Swap(String& other) {
   std::swap(string_size_, other.string_size_);
   std::swap(capacity_, other.capacity_);
   std::swap(memory_used_, other.memory_used_);
+  std::swap(resource_, other.resource_);
 }
 
 char& String::operator[](size_t i) { return characters_[i]; }
@@ -137,6 +157,8 @@ char* String::Data() { return characters_; }
 
 const char* String::Data() const { return characters_; }
 
+std::pmr::memory_resource* String::Resource() const { return resource_; }
+
 bool operator==(const String& a, const String& b) {
   if (a.Size() != b.Size()) {
     return false;
@@ -202,7 +224,7 @@ String& String::operator+=(const String& other) {
 }
 
 String operator+(const String& a, const String& b) {
-  String sum;
+  String sum(a.Resource());
   size_t size = (a.Size() + b.Size());
   sum.Resize(size);
   const auto* temp = a.Data();
@@ -221,7 +243,7 @@ String operator+(const String& a, const String& b) {
 
 String operator*(const String& str, int n) {
   size_t new_size = str.Size() * n;
-  String temp;
+  String temp(str.Resource());
   temp.Resize(new_size);
   int current = 0;
   for (int i = 0; i < n; i++) {
@@ -232,7 +254,7 @@ String operator*(const String& str, int n) {
   }
   temp[new_size] = '\0';
 
-  return {temp};
+  return temp;
 }
 
 String& operator*=(String& str, int n) {
@@ -248,7 +270,7 @@ std::istream& operator>>(std::istream& in, String& str) {
   const size_t kMaxPossible = 1000;
   char input_arr[kMaxPossible];
   in >> input_arr;
-  String temp(input_arr);
+  String temp(input_arr, str.Resource());
   str.Swap(temp);
   return in;
 }
@@ -266,7 +288,7 @@ String String::Join(const std::vector<String>& strings) {
     size_of_temp += elem.Size();
   }
 
-  String temp;
+  String temp(resource_);
   if (strings.empty()) {
     return temp;
   }
@@ -277,7 +299,7 @@ String String::Join(const std::vector<String>& strings) {
     temp[current] = strings[0][i];
     ++current;
   }
-  for (size_t i = 0; i < strings.size(); ++i) {
+  for (size_t i = 1; i < strings.size(); ++i) {
     for (size_t j = 0; j < Size(); ++j) {
       temp[current] = characters_[j];
       ++current;
@@ -293,7 +315,7 @@ String String::Join(const std::vector<String>& strings) {
 
 std::vector<String> String::Split(const String& delim /*= " "*/) const {
   std::vector<String> split_elems;
-  String next_split_elem("");
+  String next_split_elem("", resource_);
 
   size_t it = 0;
   while (Size() - it >= delim.Size()) {
@@ -302,7 +324,7 @@ std::vector<String> String::Split(const String& delim /*= " "*/) const {
       ++it;
       continue;
     }
-    split_elems.push_back(next_split_elem);
+    split_elems.emplace_back(next_split_elem, resource_);
     next_split_elem.Clear();
     it += delim.Size();
   }
@@ -310,7 +332,71 @@ std::vector<String> String::Split(const String& delim /*= " "*/) const {
     next_split_elem.PushBack(characters_[it]);
     ++it;
   }
-  split_elems.push_back(next_split_elem);
+  split_elems.push_back(std::move(next_split_elem));
 
   return split_elems;
-}
\ No newline at end of file
+}
+
+StringView::StringView() {}
+
+StringView::StringView(const char* str) : data_(str), size_(std::strlen(str)) {}
+
+StringView::StringView(const char* data, size_t size)
+    : data_(data), size_(size) {}
+
+StringView::StringView(const String& str)
+    : data_(str.Data()), size_(str.Size()) {}
+
+const char& StringView::operator[](size_t i) const { return data_[i]; }
+
+bool StringView::Empty() const { return size_ == 0; }
+
+size_t StringView::Size() const { return size_; }
+
+const char* StringView::Data() const { return data_; }
+
+StringView StringView::Substr(size_t pos, size_t count) const {
+  if (pos > size_) {
+    pos = size_;
+  }
+  if (count > size_ - pos) {
+    count = size_ - pos;
+  }
+  return {data_ + pos, count};
+}
+
+bool operator==(const StringView& a, const StringView& b) {
+  return a.Size() == b.Size() &&
+         (a.Size() == 0 || std::memcmp(a.Data(), b.Data(), a.Size()) == 0);
+}
+
+bool operator!=(const StringView& a, const StringView& b) { return !(a == b); }
+
+std::ostream& operator<<(std::ostream& out, const StringView& str) {
+  out.write(str.Data(), static_cast<std::streamsize>(str.Size()));
+  return out;
+}
+
+std::vector<StringView> StringView::Split(
+    const StringView& delim /*= " "*/) const {
+  std::vector<StringView> split_elems;
+  if (delim.Empty()) {
+    split_elems.push_back(*this);
+    return split_elems;
+  }
+
+  size_t begin = 0;
+  size_t it = 0;
+  while (size_ - it >= delim.Size()) {
+    if (std::memcmp(data_ + it, delim.Data(), delim.Size()) != 0) {
+      ++it;
+      continue;
+    }
+    split_elems.emplace_back(data_ + begin, it - begin);
+    it += delim.Size();
+    begin = it;
+  }
+  split_elems.emplace_back(data_ + begin, size_ - begin);
+
+  return split_elems;
+}
@@ -1,20 +1,37 @@
 #pragma once
 #include <cstring>
 #include <iostream>
+#include <memory_resource>
 #include <vector>
 
+// All memory comes from a std::pmr::memory_resource (the default resource
+// unless one is passed in). A copy gets the default resource unless told
+// otherwise; results of Split, Join, + and * use the resource of the left
+// operand, so request-scoped strings can live in a monotonic arena.
 class String {
 public:
   String();
 
-  String(size_t size, char character);
+  explicit String(std::pmr::memory_resource* resource);
 
-  String(const char* str);
+  String(
+      size_t size, char character,
+      std::pmr::memory_resource* resource = std::pmr::get_default_resource());
 
-  String(const String& copy);
+  String(
+      const char* str,
+      std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+  String(
+      const String& copy,
+      std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+  String(String&& other) noexcept;
 
   String& operator=(const String& str);
 
+  String& operator=(String&& str);
+
   ~String();
 
   void Clear();
@@ -55,6 +72,8 @@ public:
 
   const char* Data() const;
 
+  std::pmr::memory_resource* Resource() const;
+
   friend bool operator==(const String& a, const String& b);
 
   friend bool operator>(const String& a, const String& b);
@@ -88,4 +107,45 @@ private:
   size_t string_size_ = 0;
   size_t capacity_ = 0;
   size_t memory_used_ = 0;
+  std::pmr::memory_resource* resource_ = std::pmr::get_default_resource();
+
+  // replaces the buffer with a new one of memory_used bytes, keeping the
+  // first Size() + 1 characters
+  void Reallocate(size_t memory_used);
+};
+
+// Non-owning read-only view over a contiguous character range. Views never
+// allocate; the viewed buffer must outlive them.
+class StringView {
+public:
+  StringView();
+
+  StringView(const char* str);
+
+  StringView(const char* data, size_t size);
+
+  StringView(const String& str);
+
+  const char& operator[](size_t i) const;
+
+  bool Empty() const;
+
+  size_t Size() const;
+
+  const char* Data() const;
+
+  StringView Substr(size_t pos, size_t count) const;
+
+  friend bool operator==(const StringView& a, const StringView& b);
+
+  friend bool operator!=(const StringView& a, const StringView& b);
+
+  friend std::ostream& operator<<(std::ostream& out, const StringView& str);
+
+  // Same semantics as String::Split, but the pieces point into this view.
+  std::vector<StringView> Split(const StringView& delim = " ") const;
+
+private:
+  const char* data_ = nullptr;
+  size_t size_ = 0;
 };
\ No newline at end of file
@@ -0,0 +1,282 @@
+#include "utf8.hpp"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#if defined(__SSSE3__)
+#include <tmmintrin.h>
+#endif
+
+namespace {
+
+const size_t kBlock = 16;
+
+bool IsContinuation(char character) {
+  return (static_cast<unsigned char>(character) & 0xC0) == 0x80;
+}
+
+#if !defined(__SSSE3__)
+
+// Byte-at-a-time validation of bytes [begin, end). Returns the position of
+// the first byte that could not be validated: end on success, an earlier
+// position on an error (the caller only needs to know that it is not end).
+size_t ValidateScalar(const unsigned char* data, size_t begin, size_t end) {
+  size_t i = begin;
+  while (i < end) {
+    unsigned char lead = data[i];
+    if (lead < 0x80) {
+      ++i;
+      continue;
+    }
+    size_t length = 0;
+    unsigned char low = 0x80;
+    unsigned char high = 0xBF;
+    if (lead >= 0xC2 && lead <= 0xDF) {
+      length = 2;
+    } else if (lead >= 0xE0 && lead <= 0xEF) {
+      length = 3;
+      if (lead == 0xE0) {
+        low = 0xA0;
+      } else if (lead == 0xED) {
+        high = 0x9F;
+      }
+    } else if (lead >= 0xF0 && lead <= 0xF4) {
+      length = 4;
+      if (lead == 0xF0) {
+        low = 0x90;
+      } else if (lead == 0xF4) {
+        high = 0x8F;
+      }
+    } else {
+      return i;
+    }
+    if (end - i < length || data[i + 1] < low || data[i + 1] > high) {
+      return i;
+    }
+    for (size_t k = 2; k < length; ++k) {
+      if (!IsContinuation(static_cast<char>(data[i + k]))) {
+        return i;
+      }
+    }
+    i += length;
+  }
+  return end;
+}
+
+#endif
+
+#if defined(__SSSE3__)
+
+// Lookup-table validation after Keiser and Lemire, "Validating UTF-8 In Less
+// Than One Instruction Per Byte". Every byte is classified by the high and
+// low nibble of the previous byte and the high nibble of itself; an error is
+// reported when the three classifications share a bit.
+const int kTooShort = 1 << 0;
+const int kTooLong = 1 << 1;
+const int kOverlong3 = 1 << 2;
+const int kTooLarge = 1 << 3;
+const int kSurrogate = 1 << 4;
+const int kOverlong2 = 1 << 5;
+const int kTooLarge1000 = 1 << 6;
+const int kOverlong4 = 1 << 6;
+const int kTwoConts = 1 << 7;
+const int kCarry = kTooShort | kTooLong | kTwoConts;
+
+__m128i HighNibbles(__m128i bytes) {
+  return _mm_and_si128(_mm_srli_epi16(bytes, 4), _mm_set1_epi8(0x0F));
+}
+
+__m128i SpecialCases(__m128i input, __m128i prev1) {
+  const __m128i kByte1High = _mm_setr_epi8(
+      kTooLong, kTooLong, kTooLong, kTooLong, kTooLong, kTooLong, kTooLong,
+      kTooLong, kTwoConts, kTwoConts, kTwoConts, kTwoConts,
+      kTooShort | kOverlong2, kTooShort, kTooShort | kOverlong3 | kSurrogate,
+      kTooShort | kTooLarge | kTooLarge1000 | kOverlong4);
+  const __m128i kByte1Low = _mm_setr_epi8(
+      kCarry | kOverlong3 | kOverlong2 | kOverlong4, kCarry | kOverlong2,
+      kCarry, kCarry, kCarry | kTooLarge, kCarry | kTooLarge | kTooLarge1000,
+      kCarry | kTooLarge | kTooLarge1000, kCarry | kTooLarge | kTooLarge1000,
+      kCarry | kTooLarge | kTooLarge1000, kCarry | kTooLarge | kTooLarge1000,
+      kCarry | kTooLarge | kTooLarge1000, kCarry | kTooLarge | kTooLarge1000,
+      kCarry | kTooLarge | kTooLarge1000,
+      kCarry | kTooLarge | kTooLarge1000 | kSurrogate,
+      kCarry | kTooLarge | kTooLarge1000, kCarry | kTooLarge | kTooLarge1000);
+  const __m128i kByte2High = _mm_setr_epi8(
+      kTooShort, kTooShort, kTooShort, kTooShort, kTooShort, kTooShort,
+      kTooShort, kTooShort,
+      static_cast<char>(kTooLong | kOverlong2 | kTwoConts | kOverlong3 |
+                        kTooLarge1000 | kOverlong4),
+      static_cast<char>(kTooLong | kOverlong2 | kTwoConts | kOverlong3 |
+                        kTooLarge),
+      static_cast<char>(kTooLong | kOverlong2 | kTwoConts | kSurrogate |
+                        kTooLarge),
+      static_cast<char>(kTooLong | kOverlong2 | kTwoConts | kSurrogate |
+                        kTooLarge),
+      kTooShort, kTooShort, kTooShort, kTooShort);
+
+  __m128i byte_1_high = _mm_shuffle_epi8(kByte1High, HighNibbles(prev1));
+  __m128i byte_1_low = _mm_shuffle_epi8(
+      kByte1Low, _mm_and_si128(prev1, _mm_set1_epi8(0x0F)));
+  __m128i byte_2_high = _mm_shuffle_epi8(kByte2High, HighNibbles(input));
+  return _mm_and_si128(_mm_and_si128(byte_1_high, byte_1_low), byte_2_high);
+}
+
+// Third and fourth bytes of 3- and 4-byte sequences must be continuations
+// and are the only continuations allowed to follow another continuation.
+__m128i MultibyteLengths(__m128i input, __m128i prev_input, __m128i special) {
+  __m128i prev2 = _mm_alignr_epi8(input, prev_input, kBlock - 2);
+  __m128i prev3 = _mm_alignr_epi8(input, prev_input, kBlock - 3);
+  __m128i is_third = _mm_subs_epu8(prev2, _mm_set1_epi8(0xE0 - 0x80));
+  __m128i is_fourth = _mm_subs_epu8(prev3, _mm_set1_epi8(0xF0 - 0x80));
+  __m128i must23 = _mm_and_si128(_mm_or_si128(is_third, is_fourth),
+                                 _mm_set1_epi8(static_cast<char>(0x80)));
+  return _mm_xor_si128(must23, special);
+}
+
+// Non-zero if the block ends in the middle of a multi-byte sequence.
+__m128i Incomplete(__m128i input) {
+  const __m128i kMaxValue = _mm_setr_epi8(
+      -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+      static_cast<char>(0xF0 - 1), static_cast<char>(0xE0 - 1),
+      static_cast<char>(0xC0 - 1));
+  return _mm_subs_epu8(input, kMaxValue);
+}
+
+bool ValidateVector(const unsigned char* data, size_t size) {
+  __m128i error = _mm_setzero_si128();
+  __m128i prev_input = _mm_setzero_si128();
+  __m128i prev_incomplete = _mm_setzero_si128();
+
+  auto check_block = [&](__m128i input) {
+    if (_mm_movemask_epi8(input) == 0) {
+      error = _mm_or_si128(error, prev_incomplete);
+      prev_input = input;
+      prev_incomplete = _mm_setzero_si128();
+      return;
+    }
+    __m128i prev1 = _mm_alignr_epi8(input, prev_input, kBlock - 1);
+    __m128i special = SpecialCases(input, prev1);
+    error = _mm_or_si128(error, MultibyteLengths(input, prev_input, special));
+    prev_incomplete = Incomplete(input);
+    prev_input = input;
+  };
+
+  size_t i = 0;
+  for (; i + kBlock <= size; i += kBlock) {
+    check_block(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i)));
+  }
+  if (i < size) {
+    // The zero padding is ASCII, so it flags a truncated last sequence.
+    unsigned char tail[kBlock] = {};
+    std::memcpy(tail, data + i, size - i);
+    check_block(_mm_loadu_si128(reinterpret_cast<const __m128i*>(tail)));
+  }
+  error = _mm_or_si128(error, prev_incomplete);
+  return _mm_movemask_epi8(_mm_cmpeq_epi8(error, _mm_setzero_si128())) ==
+         0xFFFF;
+}
+
+#endif
+
+// Number of code points starting in data[0, kBlock).
+size_t CountLeadBytes(const char* data) {
+#if defined(__SSE2__)
+  __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+  // Continuation bytes are exactly the signed values below -64.
+  __m128i leads = _mm_cmpgt_epi8(bytes, _mm_set1_epi8(-65));
+  return __builtin_popcount(_mm_movemask_epi8(leads));
+#else
+  size_t count = 0;
+  for (size_t i = 0; i < kBlock; ++i) {
+    count += IsContinuation(data[i]) ? 0 : 1;
+  }
+  return count;
+#endif
+}
+
+// Byte offset of the code point count code points after the one at from.
+size_t Advance(const StringView& str, size_t from, size_t count) {
+  size_t i = from;
+  while (str.Size() - i >= kBlock) {
+    size_t leads = CountLeadBytes(str.Data() + i);
+    if (leads > count) {
+      break;
+    }
+    count -= leads;
+    i += kBlock;
+  }
+  while (i < str.Size()) {
+    if (!IsContinuation(str[i])) {
+      if (count == 0) {
+        break;
+      }
+      --count;
+    }
+    ++i;
+  }
+  return i;
+}
+
+}  // namespace
+
+bool Utf8Validate(const StringView& str) {
+  const auto* data = reinterpret_cast<const unsigned char*>(str.Data());
+#if defined(__SSSE3__)
+  return ValidateVector(data, str.Size());
+#else
+  size_t i = 0;
+#if defined(__SSE2__)
+  // Skip ASCII runs a block at a time; a block with a high bit set is
+  // validated byte by byte up to the next ASCII-only block.
+  while (i < str.Size()) {
+    while (str.Size() - i >= kBlock &&
+           _mm_movemask_epi8(_mm_loadu_si128(
+               reinterpret_cast<const __m128i*>(data + i))) == 0) {
+      i += kBlock;
+    }
+    size_t end = str.Size() - i >= kBlock ? i + kBlock : str.Size();
+    // A sequence may straddle the block end, so extend to its last byte.
+    while (end < str.Size() && IsContinuation(str[end])) {
+      ++end;
+    }
+    if (ValidateScalar(data, i, end) != end) {
+      return false;
+    }
+    i = end;
+  }
+  return true;
+#else
+  return ValidateScalar(data, i, str.Size()) == str.Size();
+#endif
+#endif
+}
+
+size_t Utf8Length(const StringView& str) {
+  size_t count = 0;
+  size_t i = 0;
+  for (; str.Size() - i >= kBlock; i += kBlock) {
+    count += CountLeadBytes(str.Data() + i);
+  }
+  for (; i < str.Size(); ++i) {
+    count += IsContinuation(str[i]) ? 0 : 1;
+  }
+  return count;
+}
+
+StringView Utf8Substr(const StringView& str, size_t pos, size_t count) {
+  size_t begin = Advance(str, 0, pos);
+  size_t end = Advance(str, begin, count);
+  return str.Substr(begin, end - begin);
+}
+
+StringView Utf8Truncate(const StringView& str, size_t max_bytes) {
+  if (str.Size() <= max_bytes) {
+    return str;
+  }
+  size_t end = max_bytes;
+  while (end > 0 && IsContinuation(str[end])) {
+    --end;
+  }
+  return str.Substr(0, end);
+}
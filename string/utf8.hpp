@@ -0,0 +1,20 @@
+#pragma once
+
+#include "string.hpp"
+
+// UTF-8 helpers. They take a StringView, so they accept String, StringView
+// and MappedString::View() alike and never copy the text.
+
+// true if str is well-formed UTF-8 (RFC 3629: no overlong forms, no
+// surrogates, nothing above U+10FFFF).
+bool Utf8Validate(const StringView& str);
+
+// Number of code points. str must be valid UTF-8.
+size_t Utf8Length(const StringView& str);
+
+// count code points starting at code point pos, clamped to the end of str.
+// str must be valid UTF-8.
+StringView Utf8Substr(const StringView& str, size_t pos, size_t count);
+
+// Longest prefix of at most max_bytes bytes that does not cut a code point.
+StringView Utf8Truncate(const StringView& str, size_t max_bytes);
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstdlib>
+#include <iostream>
+
+// Minimal checks for the test executables. A failed CHECK prints the
+// condition and where it failed, with whatever is streamed into it, and
+// execution goes on so that one run reports every failure:
+//
+//   CHECK(left * right == expected) << "with " << threads << " threads";
+//
+// main() ends with return TestResult();
+inline int& TestFailures() {
+  static int failures = 0;
+  return failures;
+}
+
+inline int TestResult() {
+  if (TestFailures() != 0) {
+    std::cerr << TestFailures() << " check(s) failed\n";
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
+
+// Ends the failure message with a newline.
+class CheckFailure {
+public:
+  CheckFailure(const char* condition, const char* file, int line) {
+    ++TestFailures();
+    std::cerr << file << ":" << line << ": CHECK(" << condition
+              << ") failed: ";
+  }
+
+  CheckFailure(const CheckFailure&) = delete;
+  CheckFailure& operator=(const CheckFailure&) = delete;
+
+  ~CheckFailure() { std::cerr << "\n"; }
+
+  template <typename Value>
+  CheckFailure& operator<<(const Value& value) {
+    std::cerr << value;
+    return *this;
+  }
+};
+
+#define CHECK(condition) \
+  if (condition) {       \
+  } else                 \
+    CheckFailure(#condition, __FILE__, __LINE__)
+
+// Checks that statement throws an exception of type Exception.
+#define CHECK_THROWS(statement, Exception) \
+  do {                                     \
+    bool thrown = false;                   \
+    try {                                  \
+      statement;                           \
+    } catch (const Exception&) {           \
+      thrown = true;                       \
+    }                                      \
+    CHECK(thrown) << #statement;           \
+  } while (false)
@@ -0,0 +1,100 @@
+// Checks operator* of Matrix and DynamicMatrix, i.e. Gemm, against a plain
+// i-k-j loop for every element type with its own microkernel and for one
+// that uses the generic kernel. The sizes are not multiples of the kernel
+// tiles or of the cache blocks, so every edge path runs, and each product is
+// computed with one thread and with several.
+//
+// The elements are small integers, so float and double products are exact
+// whatever order the kernels add in and can be compared with ==.
+
+#include <cstdint>
+#include <random>
+
+#include "../matrix/dynamic_matrix.hpp"
+#include "../matrix/matrix.hpp"
+#include "check.hpp"
+
+namespace {
+
+const size_t kThreadCounts[] = {1, 4};
+
+template <typename T>
+DynamicMatrix<T> Random(size_t rows, size_t cols, std::mt19937& random) {
+  std::uniform_int_distribution<int> element(-4, 4);
+  DynamicMatrix<T> matrix(rows, cols);
+  for (size_t i = 0; i < rows; ++i) {
+    for (size_t j = 0; j < cols; ++j) {
+      matrix(i, j) = static_cast<T>(element(random));
+    }
+  }
+  return matrix;
+}
+
+template <typename T>
+DynamicMatrix<T> Reference(const DynamicMatrix<T>& left,
+                           const DynamicMatrix<T>& right) {
+  DynamicMatrix<T> product(left.Rows(), right.Cols());
+  for (size_t i = 0; i < left.Rows(); ++i) {
+    for (size_t k = 0; k < left.Cols(); ++k) {
+      for (size_t j = 0; j < right.Cols(); ++j) {
+        product(i, j) += left(i, k) * right(k, j);
+      }
+    }
+  }
+  return product;
+}
+
+template <typename T>
+void TestDynamic(const char* type, std::mt19937& random) {
+  // n x k times k x m: tails of every tile and block, several K panels,
+  // several column tasks, and a product small enough to skip packing.
+  const size_t kShapes[][3] = {
+      {1, 1, 1}, {7, 300, 5}, {97, 263, 521}, {193, 37, 129}, {13, 517, 11}};
+  for (const auto& shape : kShapes) {
+    DynamicMatrix<T> left = Random<T>(shape[0], shape[1], random);
+    DynamicMatrix<T> right = Random<T>(shape[1], shape[2], random);
+    DynamicMatrix<T> expected = Reference(left, right);
+    for (size_t threads : kThreadCounts) {
+      ThreadPool::Instance().SetThreadCount(threads);
+      CHECK(left * right == expected)
+          << type << " " << shape[0] << "x" << shape[1] << " * " << shape[1]
+          << "x" << shape[2] << " with " << threads << " threads";
+    }
+  }
+  ThreadPool::Instance().SetThreadCount(1);
+}
+
+template <typename T>
+void TestStatic(const char* type, std::mt19937& random) {
+  const size_t kN = 131;
+  const size_t kK = 67;
+  const size_t kM = 97;
+  DynamicMatrix<T> left = Random<T>(kN, kK, random);
+  DynamicMatrix<T> right = Random<T>(kK, kM, random);
+  Matrix<kN, kK, T> left_matrix = left.template ToMatrix<kN, kK>();
+  Matrix<kK, kM, T> right_matrix = right.template ToMatrix<kK, kM>();
+  DynamicMatrix<T> expected = Reference(left, right);
+  for (size_t threads : kThreadCounts) {
+    ThreadPool::Instance().SetThreadCount(threads);
+    CHECK(DynamicMatrix<T>(left_matrix * right_matrix) == expected)
+        << type << " with " << threads << " threads";
+  }
+  ThreadPool::Instance().SetThreadCount(1);
+}
+
+template <typename T>
+void Test(const char* type, std::mt19937& random) {
+  TestDynamic<T>(type, random);
+  TestStatic<T>(type, random);
+}
+
+}  // namespace
+
+int main() {
+  std::mt19937 random(42);
+  Test<float>("float", random);
+  Test<double>("double", random);
+  Test<int32_t>("int32_t", random);
+  Test<int64_t>("int64_t", random);
+  return TestResult();
+}
@@ -0,0 +1,158 @@
+// Checks Solve, Inverse and Determinant: the blocked LU on floating-point
+// matrices of sizes around and above kLuBlock, so that more than one panel
+// and a partial last panel are factored, the singular-matrix error, and the
+// exact Bareiss determinant on int64_t and BigInt.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+
+#include "../big_integer/big_integer.hpp"
+#include "../matrix/matrix.hpp"
+#include "check.hpp"
+
+namespace {
+
+template <size_t N>
+using Square = Matrix<N, N, double>;
+
+template <size_t N>
+Square<N> Random(std::mt19937& random) {
+  std::uniform_real_distribution<double> element(-1.0, 1.0);
+  Square<N> matrix;
+  for (size_t i = 0; i < N; ++i) {
+    for (size_t j = 0; j < N; ++j) {
+      matrix(i, j) = element(random);
+    }
+  }
+  return matrix;
+}
+
+template <size_t N, size_t M>
+double MaxDistance(const Matrix<N, M, double>& left,
+                   const Matrix<N, M, double>& right) {
+  double distance = 0;
+  for (size_t i = 0; i < N; ++i) {
+    for (size_t j = 0; j < M; ++j) {
+      distance = std::max(distance, std::abs(left(i, j) - right(i, j)));
+    }
+  }
+  return distance;
+}
+
+// A * A.Inverse() == I and A * A.Solve(b) == b up to rounding.
+template <size_t N>
+void TestInverse(std::mt19937& random) {
+  const double kTolerance = 1e-9;
+  Square<N> matrix = Random<N>(random);
+  Square<N> identity;
+  for (size_t i = 0; i < N; ++i) {
+    identity(i, i) = 1.0;
+  }
+  CHECK(MaxDistance(Square<N>(matrix * matrix.Inverse()), identity) <
+        kTolerance)
+      << N << "x" << N;
+
+  std::uniform_real_distribution<double> element(-1.0, 1.0);
+  Matrix<N, 3, double> b;
+  for (size_t i = 0; i < N; ++i) {
+    for (size_t j = 0; j < 3; ++j) {
+      b(i, j) = element(random);
+    }
+  }
+  CHECK(MaxDistance(Matrix<N, 3, double>(matrix * matrix.Solve(b)), b) <
+        kTolerance)
+      << N << "x" << N;
+}
+
+// L * U with a unit lower L and an upper U of known diagonal, with two rows
+// swapped: the determinant is minus the product of that diagonal. The
+// off-diagonal elements are scaled by 1 / N, since products of random
+// triangular matrices are otherwise too ill-conditioned for any LU to get
+// the determinant right.
+template <size_t N>
+void TestDeterminant(std::mt19937& random) {
+  const double kDiagonal[] = {1.0, -1.0, 2.0, 0.5};
+  Square<N> lower = Random<N>(random) * (1.0 / N);
+  Square<N> upper = Random<N>(random) * (1.0 / N);
+  double expected = -1.0;
+  for (size_t i = 0; i < N; ++i) {
+    for (size_t j = i; j < N; ++j) {
+      lower(i, j) = i == j ? 1.0 : 0.0;
+      upper(j, i) = i == j ? kDiagonal[i % 4] : 0.0;
+    }
+    expected *= kDiagonal[i % 4];
+  }
+  Square<N> matrix = lower * upper;
+  for (size_t j = 0; j < N; ++j) {
+    std::swap(matrix(0, j), matrix(N - 1, j));
+  }
+  CHECK(std::abs(matrix.Determinant() - expected) <
+        1e-9 * std::abs(expected))
+      << N << "x" << N << ": " << matrix.Determinant() << " instead of "
+      << expected;
+}
+
+// A zero column past the first panel, and a zero row.
+template <size_t N>
+void TestSingular(std::mt19937& random) {
+  Square<N> zero_column = Random<N>(random);
+  Square<N> zero_row = zero_column;
+  for (size_t i = 0; i < N; ++i) {
+    zero_column(i, N - 2) = 0.0;
+    zero_row(N / 3, i) = 0.0;
+  }
+  for (const Square<N>* matrix : {&zero_column, &zero_row}) {
+    CHECK_THROWS(matrix->Inverse(), std::invalid_argument);
+    CHECK_THROWS(matrix->Solve(*matrix), std::invalid_argument);
+    CHECK(matrix->Determinant() == 0.0) << N << "x" << N;
+  }
+}
+
+template <size_t N>
+void TestLu(std::mt19937& random) {
+  TestInverse<N>(random);
+  TestDeterminant<N>(random);
+  TestSingular<N>(random);
+}
+
+// The Vandermonde matrix of 0, 1, ..., N - 1 with its column of ones moved
+// last, so that the first pivot is zero and rows have to be swapped. The
+// determinant is (-1)^(N - 1) times the product of (j - i) over i < j.
+template <size_t N, typename T>
+void TestExactDeterminant() {
+  Matrix<N, N, T> vandermonde;
+  T expected = N % 2 == 0 ? T(-1) : T(1);
+  for (size_t i = 0; i < N; ++i) {
+    T power = T(1);
+    for (size_t j = 0; j < N; ++j) {
+      vandermonde(i, (j + N - 1) % N) = power;
+      power *= T(static_cast<int64_t>(i));
+    }
+    for (size_t j = i + 1; j < N; ++j) {
+      expected *= T(static_cast<int64_t>(j - i));
+    }
+  }
+  CHECK(vandermonde.Determinant() == expected)
+      << N << "x" << N << ": " << vandermonde.Determinant() << " instead of "
+      << expected;
+}
+
+}  // namespace
+
+int main() {
+  std::mt19937 random(42);
+  TestLu<5>(random);
+  TestLu<64>(random);
+  TestLu<65>(random);
+  TestLu<150>(random);
+
+  // Up to sign the determinant is 1! 2! ... (N - 1)!, which for N = 16
+  // needs BigInt.
+  TestExactDeterminant<7, int64_t>();
+  TestExactDeterminant<8, BigInt>();
+  TestExactDeterminant<16, BigInt>();
+  return TestResult();
+}
@@ -0,0 +1,172 @@
+// Checks Utf8Validate against a byte-at-a-time reference decoder on text
+// with invalid sequences (overlong forms, surrogates, code points above
+// U+10FFFF, stray continuation bytes and truncated sequences) at every
+// offset around the 16-byte block boundaries and in the zero-padded tail,
+// and on random mixes of valid and invalid sequences. Utf8Length is checked
+// on the valid ones.
+//
+// The build runs this once against the library, which uses the SSSE3
+// lookup-table validator when the target has SSSE3, and once with utf8.cpp
+// compiled without SSSE3, which uses the SSE2 ASCII skip and the scalar
+// validator.
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../string/utf8.hpp"
+#include "check.hpp"
+
+namespace {
+
+// Decodes every sequence and checks the code point it encodes, rather than
+// the table of valid second bytes the library uses.
+bool ReferenceValidate(const std::string& text) {
+  size_t i = 0;
+  while (i < text.size()) {
+    auto lead = static_cast<unsigned char>(text[i]);
+    if (lead < 0x80) {
+      ++i;
+      continue;
+    }
+    size_t length = 0;
+    uint32_t code_point = 0;
+    uint32_t min = 0;
+    if ((lead & 0xE0) == 0xC0) {
+      length = 2;
+      code_point = lead & 0x1F;
+      min = 0x80;
+    } else if ((lead & 0xF0) == 0xE0) {
+      length = 3;
+      code_point = lead & 0x0F;
+      min = 0x800;
+    } else if ((lead & 0xF8) == 0xF0) {
+      length = 4;
+      code_point = lead & 0x07;
+      min = 0x10000;
+    } else {
+      return false;
+    }
+    if (text.size() - i < length) {
+      return false;
+    }
+    for (size_t k = 1; k < length; ++k) {
+      auto byte = static_cast<unsigned char>(text[i + k]);
+      if ((byte & 0xC0) != 0x80) {
+        return false;
+      }
+      code_point = code_point << 6 | (byte & 0x3F);
+    }
+    if (code_point < min || code_point > 0x10FFFF ||
+        (code_point >= 0xD800 && code_point <= 0xDFFF)) {
+      return false;
+    }
+    i += length;
+  }
+  return true;
+}
+
+size_t ReferenceLength(const std::string& text) {
+  size_t length = 0;
+  for (char character : text) {
+    length += (static_cast<unsigned char>(character) & 0xC0) != 0x80 ? 1 : 0;
+  }
+  return length;
+}
+
+const std::vector<std::string> kValid = {
+    "a",                 "\x7F",
+    "\xC2\x80",          "\xC3\xA9",         "\xDF\xBF",
+    "\xE0\xA0\x80",      "\xE2\x82\xAC",     "\xED\x9F\xBF",
+    "\xEE\x80\x80",      "\xEF\xBF\xBF",     "\xF0\x90\x80\x80",
+    "\xF0\x9F\x98\x80",  "\xF4\x8F\xBF\xBF"};
+
+const std::vector<std::string> kInvalid = {
+    // Overlong forms.
+    "\xC0\x80", "\xC1\xBF", "\xE0\x80\x80", "\xE0\x9F\xBF",
+    "\xF0\x80\x80\x80", "\xF0\x8F\xBF\xBF",
+    // Surrogates.
+    "\xED\xA0\x80", "\xED\xBF\xBF",
+    // Above U+10FFFF.
+    "\xF4\x90\x80\x80", "\xF5\x80\x80\x80", "\xF7\xBF\xBF\xBF",
+    // Bytes that are never valid.
+    "\xF8\x88\x80\x80\x80", "\xFE", "\xFF",
+    // Stray continuations, one more than the lead announces.
+    "\x80", "\xBF", "\xC3\xA9\xA9", "\xE2\x82\xAC\x80",
+    // Truncated sequences, followed by whatever comes next.
+    "\xC3", "\xE2\x82", "\xE2", "\xF0\x9F\x98", "\xF0\x9F", "\xF4"};
+
+// size bytes of valid text, ASCII or only multibyte characters (padded with
+// ASCII to the exact size).
+std::string Filler(size_t size, bool multibyte) {
+  std::string text;
+  for (size_t i = 0; text.size() < size; ++i) {
+    const std::string& next = kValid[2 + i % (kValid.size() - 2)];
+    text += multibyte && text.size() + next.size() <= size ? next : "a";
+  }
+  return text;
+}
+
+bool Validate(const std::string& text) {
+  return Utf8Validate(StringView(text.data(), text.size()));
+}
+
+// Every sequence at every position across two block boundaries, followed by
+// nothing (so it ends the text, in the padded tail) or by more text.
+void TestEveryOffset() {
+  const size_t kMaxPrefix = 48;
+  const size_t kMaxSuffix = 20;
+  std::vector<std::string> sequences = kValid;
+  sequences.insert(sequences.end(), kInvalid.begin(), kInvalid.end());
+  for (const std::string& sequence : sequences) {
+    for (bool multibyte : {false, true}) {
+      for (size_t prefix = 0; prefix <= kMaxPrefix; ++prefix) {
+        for (size_t suffix = 0; suffix <= kMaxSuffix; ++suffix) {
+          std::string text = Filler(prefix, multibyte) + sequence +
+                             Filler(suffix, multibyte);
+          CHECK(Validate(text) == ReferenceValidate(text))
+              << "sequence of " << sequence.size() << " bytes at offset "
+              << prefix << " of " << text.size();
+        }
+      }
+    }
+  }
+}
+
+void TestRandom() {
+  const int kTexts = 20000;
+  const size_t kMaxPieces = 40;
+  std::mt19937 random(42);
+  std::uniform_int_distribution<size_t> pieces(0, kMaxPieces);
+  std::uniform_int_distribution<size_t> valid(0, kValid.size() - 1);
+  std::uniform_int_distribution<size_t> invalid(0, kInvalid.size() - 1);
+  std::uniform_int_distribution<int> percent(0, 99);
+  size_t valid_texts = 0;
+  for (int round = 0; round < kTexts; ++round) {
+    // Half of the texts are valid, the others mostly have one error.
+    int error_percent = round % 2 == 0 ? 0 : 3;
+    std::string text;
+    for (size_t piece = pieces(random); piece > 0; --piece) {
+      text += percent(random) < error_percent ? kInvalid[invalid(random)]
+                                              : kValid[valid(random)];
+    }
+    bool expected = ReferenceValidate(text);
+    CHECK(Validate(text) == expected) << "random text " << round;
+    if (expected) {
+      ++valid_texts;
+      CHECK(Utf8Length(StringView(text.data(), text.size())) ==
+            ReferenceLength(text))
+          << "random text " << round;
+    }
+  }
+  CHECK(valid_texts > kTexts / 2) << valid_texts;
+}
+
+}  // namespace
+
+int main() {
+  TestEveryOffset();
+  TestRandom();
+  return TestResult();
+}
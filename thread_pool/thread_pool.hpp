@@ -0,0 +1,243 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Parallel loops below this much work (roughly element operations,
+// multiply-adds for products, or bytes scanned) run inline on the calling
+// thread.
+const size_t kParallelMinWork = 1 << 18;
+
+// Process-wide pool behind the parallel Matrix operations and
+// SplitParallel. It starts with a single thread, i.e. everything runs
+// serially on the caller, until SetThreadCount() is called.
+//
+// ParallelFor hands every participant (the caller included) a contiguous
+// range of task indices. A participant takes tasks from the front of its own
+// range and, once it is empty, steals the back half of another participant's
+// range, so uneven tasks still keep all threads busy.
+class ThreadPool {
+public:
+  static ThreadPool& Instance() {
+    static ThreadPool pool;
+    return pool;
+  }
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  ~ThreadPool() { StopWorkers(); }
+
+  // threads == 0 means one per hardware thread. Must not be called while a
+  // parallel operation is running.
+  void SetThreadCount(size_t threads) {
+    if (threads == 0) {
+      threads = std::max(1U, std::thread::hardware_concurrency());
+    }
+    std::lock_guard<std::mutex> job_lock(job_mutex_);
+    StopWorkers();
+    ranges_ = std::vector<Range>(threads);
+    for (size_t i = 1; i < threads; ++i) {
+      workers_.emplace_back(&ThreadPool::WorkerLoop, this, i);
+    }
+  }
+
+  size_t ThreadCount() const { return ranges_.size(); }
+
+  // Calls body(task) for every task in [0, tasks). work is the total cost
+  // estimate compared against kParallelMinWork. Nested calls from inside a
+  // task run serially. If a task throws, the tasks not started yet are
+  // skipped and the first exception is rethrown on the caller once every
+  // thread has left the job.
+  template <typename Body>
+  void ParallelFor(size_t tasks, size_t work, const Body& body) {
+    if (tasks <= 1 || work < kParallelMinWork || ranges_.size() <= 1 ||
+        InsideTask()) {
+      for (size_t task = 0; task < tasks; ++task) {
+        body(task);
+      }
+      return;
+    }
+    Run(tasks, &CallBody<Body>, &body);
+  }
+
+private:
+  using Trampoline = void (*)(const void*, size_t);
+
+  struct Range {
+    std::mutex mutex;
+    size_t begin = 0;
+    size_t end = 0;
+  };
+
+  std::vector<Range> ranges_ = std::vector<Range>(1);
+  std::vector<std::thread> workers_;
+
+  // Serializes jobs and thread count changes.
+  std::mutex job_mutex_;
+  // Guards everything below.
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  std::condition_variable idle_;
+  size_t generation_ = 0;
+  size_t active_ = 0;
+  bool job_open_ = false;
+  bool stop_ = false;
+  Trampoline call_ = nullptr;
+  const void* body_ = nullptr;
+  // The first exception thrown by a task of the current job.
+  std::exception_ptr error_;
+  // Set once error_ is, so that the remaining tasks are only drained.
+  std::atomic<bool> failed_{false};
+
+  ThreadPool() = default;
+
+  template <typename Body>
+  static void CallBody(const void* body, size_t task) {
+    (*static_cast<const Body*>(body))(task);
+  }
+
+  static bool& InsideTask() {
+    static thread_local bool inside = false;
+    return inside;
+  }
+
+  // Marks the current thread as running tasks for its lifetime.
+  class TaskScope {
+  public:
+    TaskScope() { InsideTask() = true; }
+    TaskScope(const TaskScope&) = delete;
+    TaskScope& operator=(const TaskScope&) = delete;
+    ~TaskScope() { InsideTask() = false; }
+  };
+
+  void Run(size_t tasks, Trampoline call, const void* body) {
+    std::lock_guard<std::mutex> job_lock(job_mutex_);
+    size_t participants = ranges_.size();
+    for (size_t i = 0; i < participants; ++i) {
+      ranges_[i].begin = tasks * i / participants;
+      ranges_[i].end = tasks * (i + 1) / participants;
+    }
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      call_ = call;
+      body_ = body;
+      error_ = nullptr;
+      failed_.store(false, std::memory_order_relaxed);
+      job_open_ = true;
+      ++generation_;
+    }
+    wake_.notify_all();
+
+    RunTasks(0);
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    // Workers that have not joined yet would find nothing left to do.
+    job_open_ = false;
+    idle_.wait(lock, [this] { return active_ == 0; });
+    if (error_) {
+      std::exception_ptr error = std::move(error_);
+      error_ = nullptr;
+      std::rethrow_exception(error);
+    }
+  }
+
+  // Never throws: an exception from a task is stored in error_, and the
+  // remaining tasks are taken without being run.
+  void RunTasks(size_t self) {
+    TaskScope scope;
+    size_t task = 0;
+    while (true) {
+      if (TakeTask(self, task)) {
+        if (failed_.load(std::memory_order_relaxed)) {
+          continue;
+        }
+        try {
+          call_(body_, task);
+        } catch (...) {
+          std::lock_guard<std::mutex> lock(mutex_);
+          if (!error_) {
+            error_ = std::current_exception();
+          }
+          failed_.store(true, std::memory_order_relaxed);
+        }
+      } else if (!StealTasks(self)) {
+        break;
+      }
+    }
+  }
+
+  bool TakeTask(size_t self, size_t& task) {
+    Range& own = ranges_[self];
+    std::lock_guard<std::mutex> lock(own.mutex);
+    if (own.begin == own.end) {
+      return false;
+    }
+    task = own.begin++;
+    return true;
+  }
+
+  // Moves the back half of the first non-empty foreign range into our own.
+  bool StealTasks(size_t self) {
+    for (size_t shift = 1; shift < ranges_.size(); ++shift) {
+      Range& victim = ranges_[(self + shift) % ranges_.size()];
+      size_t begin = 0;
+      size_t end = 0;
+      {
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (victim.begin == victim.end) {
+          continue;
+        }
+        end = victim.end;
+        begin = victim.begin + (victim.end - victim.begin) / 2;
+        victim.end = begin;
+      }
+      Range& own = ranges_[self];
+      std::lock_guard<std::mutex> lock(own.mutex);
+      own.begin = begin;
+      own.end = end;
+      return true;
+    }
+    return false;
+  }
+
+  void WorkerLoop(size_t self) {
+    size_t seen = 0;
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+      wake_.wait(lock, [&] { return stop_ || generation_ != seen; });
+      if (stop_) {
+        return;
+      }
+      seen = generation_;
+      if (!job_open_) {
+        continue;
+      }
+      ++active_;
+      lock.unlock();
+      RunTasks(self);
+      lock.lock();
+      if (--active_ == 0) {
+        idle_.notify_all();
+      }
+    }
+  }
+
+  void StopWorkers() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    wake_.notify_all();
+    for (auto& worker : workers_) {
+      worker.join();
+    }
+    workers_.clear();
+    stop_ = false;
+  }
+};